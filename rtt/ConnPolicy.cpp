@@ -81,7 +81,7 @@ namespace RTT
     }
 
     ConnPolicy::ConnPolicy(int type /* = DATA*/, int lock_policy /*= LOCK_FREE*/)
-        : type(type), init(false), lock_policy(lock_policy), pull(false), size(0), transport(0), data_size(0) {}
+        : type(type), init(false), lock_policy(lock_policy), pull(false), size(0), transport(0), data_size(0), shared(false), batch(0) {}
 
     /** @cond */
     /** This is dead code. We use the boost::serialization now.
@@ -206,6 +206,8 @@ namespace RTT
         os << pull << " ";
         os << lock_policy << " ";
         os << type;
+        if (cp.shared) os << " SHARED";
+        if (cp.batch > 1) os << " (batch=" << cp.batch << ")";
         if (!cp.name_id.empty()) os << " (name_id=" << cp.name_id << ")";
 
         return os;
@@ -85,6 +85,15 @@ namespace RTT {
      *       If you leave this empty (recommended), the protocol will try to guess it.
      *       The unit of data size is protocol dependent.
      *
+     *  <li> if the connection's storage is shared. All local connections of one
+     *       output port with the shared flag set and the same type, size and locking
+     *       policy then use one data object or buffer, with a read position per
+     *       reader. A write() is stored only once, independent of the number of readers.
+     *
+     *  <li> the batch size. Transports which support it pack up to this number of
+     *       samples in one message, which saves a system call per sample on
+     *       high rate connections. The default (0) sends each sample on its own.
+     *
      *  <li> the name of the connection. Can be used to coordinate out of band
      *       transport such that they can find each other by name. In practice,
      *       the name contains a port number or file descriptor to be opened.
@@ -187,6 +196,23 @@ namespace RTT {
          * work around name clashes or if the transport protocol documents to do so.
          */
         mutable std::string name_id;
+
+        /**
+         * If true, this connection shares its data object or buffer with the other
+         * shared connections of the same output port that have a compatible policy.
+         * A shared buffer never blocks the writer: a reader that lags more than
+         * \a size samples behind loses its oldest samples.
+         * This is only used for local (in-process) connections.
+         */
+        bool   shared;
+
+        /**
+         * The maximum number of samples an out-of-band transport may pack in one
+         * message. A batch is sent when it is full, when the next sample does not
+         * fit anymore or when the updateHook() of the writing component returns.
+         * Both ends of a connection must use the same value. 0 or 1 disables batching.
+         */
+        int    batch;
     };
 
     std::ostream &operator<<(std::ostream &os, const ConnPolicy &cp);
@@ -43,12 +43,15 @@
 #include "rtt-fwd.hpp"
 #include "os/MutexLock.hpp"
 #include "internal/MWSRQueue.hpp"
+#include "internal/ExecutionProfiler.hpp"
+#include "os/CAS.hpp"
 #include "TaskContext.hpp"
 #include "internal/CatchConfig.hpp"
 #include "extras/SlaveActivity.hpp"
 
 #include <boost/bind.hpp>
 #include <algorithm>
+#include <functional>
 
 #define ORONUM_EE_MQUEUE_SIZE 100
 
@@ -70,7 +73,8 @@ namespace RTT
           mqueue(new MWSRQueue<DisposableInterface*>(ORONUM_EE_MQUEUE_SIZE) ),
           port_queue(new MWSRQueue<PortInterface*>(ORONUM_EE_MQUEUE_SIZE) ),
           f_queue( new MWSRQueue<ExecutableInterface*>(ORONUM_EE_MQUEUE_SIZE) ),
-          mmaster(0)
+          update_listeners(0),
+          mmaster(0), mprofiler(0), mprofiling(false)
     {
     }
 
@@ -89,6 +93,7 @@ namespace RTT
         delete f_queue;
         delete port_queue;
         delete mqueue;
+        delete mprofiler;
     }
 
     TaskCore* ExecutionEngine::getParent() {
@@ -187,6 +192,30 @@ namespace RTT
         return true;
     }
 
+    bool ExecutionEngine::addUpdateListener(ExecutableInterface* f)
+    {
+        MutexLock locker( update_listeners_lock );
+        if ( !f || update_listeners.find_if( boost::bind(std::equal_to<ExecutableInterface*>(), _1, f) ) == f )
+            return false;
+        update_listeners.grow(1);
+        update_listeners.append(f);
+        return true;
+    }
+
+    bool ExecutionEngine::removeUpdateListener(ExecutableInterface* f)
+    {
+        MutexLock locker( update_listeners_lock );
+        if ( !update_listeners.erase(f) )
+            return false;
+        update_listeners.shrink(1);
+        return true;
+    }
+
+    static void executeListener(ExecutableInterface* f)
+    {
+        f->execute();
+    }
+
     bool ExecutionEngine::initialize() {
         return true;
     }
@@ -380,7 +409,9 @@ namespace RTT
                 break;
             }
         }
-        if (reason == RunnableInterface::Trigger) {
+        if (mprofiling) {
+            profiledWork(reason);
+        } else if (reason == RunnableInterface::Trigger) {
             /* Callback step */
             processMessages();
             processPortCallbacks();
@@ -392,6 +423,49 @@ namespace RTT
             processHooks();
         }
     }
+
+    void ExecutionEngine::profiledWork(RunnableInterface::WorkReason reason) {
+        // Same as work(), but measures each step.
+        bool update = (reason == RunnableInterface::TimeOut || reason == RunnableInterface::IOReady);
+        mprofiler->startCycle(update, this->getActivity() ? this->getActivity()->getPeriod() : 0.0,
+                              mqueue->size(), port_queue->size(), f_queue->size());
+        processMessages();
+        mprofiler->endPhase(ExecutionProfiler::Messages);
+        processPortCallbacks();
+        mprofiler->endPhase(ExecutionProfiler::Callbacks);
+        if (update) {
+            processFunctions();
+            mprofiler->endPhase(ExecutionProfiler::Functions);
+            processHooks();
+            mprofiler->endPhase(ExecutionProfiler::Hook);
+        }
+        mprofiler->endCycle();
+    }
+
+    void ExecutionEngine::setProfiling(bool on) {
+        if (on && !mprofiler) {
+            ExecutionProfiler* profiler = new ExecutionProfiler();
+            if ( !os::CAS(&mprofiler, (ExecutionProfiler*)0, profiler) )
+                delete profiler;
+        }
+        mprofiling = on;
+    }
+
+    bool ExecutionEngine::isProfiling() const {
+        return mprofiling;
+    }
+
+    ExecutionStatistics ExecutionEngine::getStatistics() const {
+        if (mprofiler)
+            return mprofiler->getStatistics();
+        return ExecutionStatistics();
+    }
+
+    void ExecutionEngine::resetStatistics() {
+        if (mprofiler)
+            mprofiler->reset();
+    }
+
     void ExecutionEngine::processHooks() {
         // only call updateHook in the Running state.
         if ( taskc ) {
@@ -407,6 +481,7 @@ namespace RTT
                     log(Error) << "in updateHook(): switching to exception state because of unhandled exception" << endlog();
                     taskc->exception(); // calls stopHook,cleanupHook
                 )
+                update_listeners.apply( &executeListener );
             }
             // in case start() or updateHook() called error(), this will be called:
             if (taskc->mTaskState == TaskCore::RunTimeError && taskc->mTargetState >= TaskCore::Running) {
@@ -47,6 +47,7 @@
 #include "base/DisposableInterface.hpp"
 #include "base/ExecutableInterface.hpp"
 #include "internal/List.hpp"
+#include "ExecutionStatistics.hpp"
 #include <vector>
 #include <boost/function.hpp>
 
@@ -137,6 +138,23 @@ namespace RTT
          */
         virtual bool removeSelfFunction(base::ExecutableInterface* f);
 
+        /**
+         * Executes \a f each time after the updateHook() of the owner of
+         * this engine returned, in the thread of this engine. Transports
+         * use this to send out the samples written during an update.
+         * The return value of f->execute() is ignored.
+         * @return false if \a f was already added.
+         * @nts
+         */
+        bool addUpdateListener(base::ExecutableInterface* f);
+
+        /**
+         * Removes a function added with addUpdateListener.
+         * @return false if \a f was not added.
+         * @nts
+         */
+        bool removeUpdateListener(base::ExecutableInterface* f);
+
         /**
          * Call this if you wish to block on a message arriving in the Execution Engine.
          * Each time one or more messages are processed, waitForMessages will return
@@ -197,6 +215,33 @@ namespace RTT
          */
         bool isSelf() const;
 
+        /**
+         * Enables or disables the collection of execution time
+         * statistics. The statistics are kept when profiling is
+         * disabled and continue when it is enabled again.
+         * @nts
+         */
+        void setProfiling(bool on);
+
+        /**
+         * Returns true if execution time statistics are collected.
+         */
+        bool isProfiling() const;
+
+        /**
+         * Returns the execution time statistics as they were at the end
+         * of the last cycle. This never blocks the engine.
+         * @nts
+         */
+        ExecutionStatistics getStatistics() const;
+
+        /**
+         * Clears the execution time statistics at the start of the
+         * next cycle.
+         * @nts
+         */
+        void resetStatistics();
+
     protected:
         /**
          * Call this if you wish to block on a message arriving in the Execution Engine.
@@ -247,6 +292,12 @@ namespace RTT
          */
         internal::MWSRQueue<base::ExecutableInterface*>* f_queue;
 
+        /**
+         * Functions executed after each updateHook().
+         */
+        internal::List<base::ExecutableInterface*> update_listeners;
+        os::Mutex update_listeners_lock;
+
         os::Mutex msg_lock;
         os::Condition msg_cond;
 
@@ -256,11 +307,23 @@ namespace RTT
          */
         ExecutionEngine *mmaster;
 
+        /**
+         * Created when profiling is first enabled and kept
+         * until the engine is destroyed.
+         */
+        internal::ExecutionProfiler* volatile mprofiler;
+        volatile bool mprofiling;
+
         void processMessages();
         void processPortCallbacks();
         void processFunctions();
         void processHooks();
 
+        /**
+         * The work() of a cycle in which profiling is enabled.
+         */
+        void profiledWork(RunnableInterface::WorkReason reason);
+
         virtual bool initialize();
 
         /**
@@ -0,0 +1,109 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_EXECUTION_STATISTICS_HPP
+#define ORO_EXECUTION_STATISTICS_HPP
+
+#include "rtt-config.h"
+
+namespace RTT {
+    /**
+     * The execution time statistics of an ExecutionEngine, as returned by
+     * ExecutionEngine::getStatistics(). All times are in seconds. They are
+     * only collected while profiling is enabled, see
+     * ExecutionEngine::setProfiling().
+     *
+     * A cycle is one execution of the engine by its activity. Messages
+     * and port callbacks are processed in every cycle, functions and the
+     * updateHook() only in the update cycles, which are the ones caused by
+     * a timeout, a periodic activity or a file descriptor activity.
+     */
+    struct RTT_API ExecutionStatistics
+    {
+        /**
+         * The number of bins of hook_histogram.
+         */
+        enum { HistogramBins = 16 };
+
+        ExecutionStatistics()
+            : cycles(0), updates(0),
+              messages_mean(0.0), messages_max(0.0),
+              callbacks_mean(0.0), callbacks_max(0.0),
+              functions_mean(0.0), functions_max(0.0),
+              hook_mean(0.0), hook_max(0.0),
+              period(0.0), jitter_mean(0.0), jitter_max(0.0), overruns(0),
+              messages_depth_max(0), callbacks_depth_max(0), functions_depth_max(0)
+        {
+            for (int i = 0; i != HistogramBins; ++i)
+                hook_histogram[i] = 0;
+        }
+
+        /** The number of cycles. */
+        unsigned int cycles;
+        /** The number of update cycles. */
+        unsigned int updates;
+
+        /** The time spent in processing messages per cycle. */
+        double messages_mean, messages_max;
+        /** The time spent in port callbacks per cycle. */
+        double callbacks_mean, callbacks_max;
+        /** The time spent in running functions per update cycle. */
+        double functions_mean, functions_max;
+        /** The time spent in updateHook() per update cycle. */
+        double hook_mean, hook_max;
+
+        /**
+         * The updateHook() durations. Bin 0 counts the durations
+         * below one microsecond and bin i those below 2^i microseconds.
+         * The last bin counts all others.
+         */
+        unsigned int hook_histogram[HistogramBins];
+
+        /** The period of the activity, zero if it is not periodic. */
+        double period;
+        /**
+         * The difference between the measured and the configured
+         * period of the periodic update cycles.
+         */
+        double jitter_mean, jitter_max;
+        /** The number of update cycles that took longer than the period. */
+        unsigned int overruns;
+
+        /**
+         * The largest number of messages, port callbacks and functions
+         * that were waiting at the start of a cycle.
+         */
+        unsigned int messages_depth_max, callbacks_depth_max, functions_depth_max;
+    };
+}
+
+#endif
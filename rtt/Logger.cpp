@@ -62,9 +62,25 @@
 #endif
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
 #include "rtt-config.h"
 #include "rtt-fwd.hpp"
 
+#ifndef OROBLD_DISABLE_LOGGING
+#include "Activity.hpp"
+#include "base/RunnableInterface.hpp"
+#include "internal/AtomicRingBuffer.hpp"
+#include "os/Atomic.hpp"
+
+#ifdef _MSC_VER
+# define ORO_LOGGER_TLS __declspec(thread)
+#else
+# define ORO_LOGGER_TLS __thread
+#endif
+#endif
+
 namespace RTT
 {
     using namespace std;
@@ -114,6 +130,85 @@ namespace RTT
 
 #endif
 
+    namespace {
+        /** The maximum length of a module name in an asynchronous record. */
+        const unsigned int ModuleSize = 32;
+        /** The maximum length of a message in an asynchronous record. */
+        const unsigned int RecordSize = 256;
+
+        /**
+         * A message as it is queued by a thread in asynchronous mode.
+         */
+        struct LogRecord
+        {
+            TimeService::ticks time;
+            Logger::LogLevel level;
+            bool tostdout;
+            bool tofile;
+            char module[ModuleSize];
+            char text[RecordSize];
+        };
+
+        /**
+         * A stream buffer which formats in a fixed array and silently
+         * truncates what does not fit.
+         */
+        class RecordBuf : public std::streambuf
+        {
+            char* mbuf;
+            std::size_t msize;
+        public:
+            RecordBuf(char* buf, std::size_t size) : mbuf(buf), msize(size) { reset(); }
+            void reset() { setp(mbuf, mbuf + msize - 1); }
+            std::size_t length() const { return pptr() - pbase(); }
+        protected:
+            int_type overflow(int_type) { return traits_type::eof(); }
+        };
+
+        /**
+         * The asynchronous logging state of one thread.
+         */
+        struct ThreadLog
+        {
+            ThreadLog(unsigned int records, Logger::LogLevel level, std::string const& module)
+                : ring(records), buf(record.text, RecordSize), line(&buf), filtered(false), reported(0)
+            {
+                record.level = level;
+                setModule(module.c_str());
+            }
+
+            void setModule(const char* module)
+            {
+                strncpy(record.module, module, ModuleSize - 1);
+                record.module[ModuleSize - 1] = 0;
+            }
+
+            /** Stops formatting when the current message will not be logged. */
+            void filter(bool f)
+            {
+                filtered = f;
+                line.clear( f ? std::ios::failbit : std::ios::goodbit );
+            }
+
+            internal::AtomicRingBuffer<LogRecord, false, false> ring;
+            /** The message being formatted */
+            LogRecord record;
+            RecordBuf buf;
+            std::ostream line;
+            bool filtered;
+            /** The number of messages dropped because ring was full */
+            os::AtomicInt dropped;
+            /** The number of dropped messages reported by the drainer */
+            int reported;
+        };
+
+        /** The ThreadLog of the calling thread, valid if thread_log_id is the logger's id. */
+        ORO_LOGGER_TLS ThreadLog* thread_log = 0;
+        ORO_LOGGER_TLS unsigned int thread_log_id = 0;
+        /** Distinguishes successive Logger instances */
+        unsigned int logger_ids = 0;
+    }
+
     Logger& Logger::log() {
         return *Instance();
     }
@@ -147,7 +242,9 @@ namespace RTT
               timestamp(0),
               started(false), showtime(true), allowRT(false),
               mlogStdOut(true), mlogFile(true),
-              moduleptr("Logger")
+              moduleptr("Logger"),
+              async(false), records(0), drainer(this), drainer_activity(0),
+              id(++logger_ids)
         {
 #if defined(OROSEM_FILE_LOGGING) && !defined(OROSEM_LOG4CPP_LOGGING) && defined(OROSEM_PRINTF_LOGGING)
             logfile = fopen(logfile_name ? logfile_name : "orocos.log","w");
@@ -161,13 +258,21 @@ namespace RTT
         }
 
         bool maylogStdOut() const {
-            if ( inloglevel <= outloglevel && outloglevel != Never && inloglevel != Never && mlogStdOut)
+            return maylogStdOut(inloglevel);
+        }
+
+        bool maylogStdOut(LogLevel ll) const {
+            if ( ll <= outloglevel && outloglevel != Never && ll != Never && mlogStdOut)
                 return true;
             return false;
         }
 
         bool maylogFile() const {
-            if ( (inloglevel <= Info || inloglevel <= outloglevel)  && mlogFile)
+            return maylogFile(inloglevel);
+        }
+
+        bool maylogFile(LogLevel ll) const {
+            if ( (ll <= Info || ll <= outloglevel)  && mlogFile)
                 return true;
             return false;
         }
@@ -261,10 +366,15 @@ namespace RTT
 
         std::string showTime() const
         {
-            std::stringstream time;
+            return showTime( TimeService::Instance()->getTicks() );
+        }
+
+        std::string showTime(TimeService::ticks time) const
+        {
+            std::stringstream stime;
             if ( showtime )
-                time <<fixed<< showpoint << setprecision(3) << TimeService::Instance()->secondsSince(timestamp);
-            return time.str();
+                stime <<fixed<< showpoint << setprecision(3) << Seconds(TimeService::ticks2nsecs(time - timestamp))/NSECS_IN_SECS;
+            return stime.str();
         }
 
         /**
@@ -320,6 +430,153 @@ namespace RTT
         std::string moduleptr;
 
         os::Mutex inpguard;
+
+        /**
+         * Returns the ThreadLog of the calling thread, and creates it
+         * if this thread did not log asynchronously before.
+         */
+        ThreadLog* threadLog()
+        {
+            if ( thread_log_id != id ) {
+                ThreadLog* tl;
+                {
+                    os::MutexLock lock( inpguard );
+                    tl = new ThreadLog( records, inloglevel, moduleptr );
+                }
+                tl->filter( !maylogStdOut(tl->record.level) && !maylogFile(tl->record.level) );
+                {
+                    os::MutexLock lock( threadlogs_lock );
+                    threadlogs.push_back( tl );
+                }
+                thread_log = tl;
+                thread_log_id = id;
+            }
+            return thread_log;
+        }
+
+        void setLevel(LogLevel ll)
+        {
+            ThreadLog* tl = threadLog();
+            tl->record.level = ll;
+            tl->filter( !maylogStdOut(ll) && !maylogFile(ll) );
+        }
+
+        /**
+         * Queues the message of the calling thread in its ring. This
+         * is the asynchronous counterpart of logit().
+         */
+        void queue()
+        {
+            ThreadLog* tl = threadLog();
+            LogRecord& r = tl->record;
+            if ( !tl->filtered ) {
+                r.time = TimeService::Instance()->getTicks();
+                r.text[ tl->buf.length() ] = 0;
+                r.tostdout = maylogStdOut(r.level);
+                r.tofile = maylogFile(r.level);
+                if ( !tl->ring.enqueue(r) )
+                    tl->dropped.inc();
+            }
+            tl->buf.reset();
+            tl->filter( !maylogStdOut(r.level) && !maylogFile(r.level) );
+        }
+
+        /**
+         * Writes a queued record to the output streams.
+         */
+        void write(LogRecord const& r)
+        {
+            os::MutexLock lock( inpguard );
+            std::string res = showTime(r.time) + " " + showLevel(r.level) + "[" + r.module + "] ";
+            if ( r.tostdout ) {
+#ifndef OROSEM_PRINTF_LOGGING
+                *stdoutput << res << r.text << '\n';
+#else
+                printf("%s%s\n", res.c_str(), r.text );
+#endif
+            }
+
+            if ( r.tofile ) {
+#ifdef OROSEM_FILE_LOGGING
+#if     defined(OROSEM_LOG4CPP_LOGGING)
+                category.log(level2Priority(r.level), r.text);
+#elif   !defined(OROSEM_PRINTF_LOGGING)
+                logfile << res << r.text << '\n';
+#else
+                fprintf( logfile, "%s%s\n", res.c_str(), r.text );
+#endif
+#endif
+#ifdef OROSEM_REMOTE_LOGGING
+                remotestring.Push(res + r.text);
+#endif
+            }
+        }
+
+        /**
+         * Writes all queued records to the output streams and reports
+         * the dropped ones.
+         */
+        void drain()
+        {
+            os::MutexLock lock( threadlogs_lock );
+            LogRecord r;
+            bool written = false;
+            for (std::vector<ThreadLog*>::iterator it = threadlogs.begin(); it != threadlogs.end(); ++it) {
+                while ( (*it)->ring.dequeue(r) ) {
+                    write(r);
+                    written = true;
+                }
+                int dropped = (*it)->dropped.read();
+                if ( dropped != (*it)->reported ) {
+                    r.time = TimeService::Instance()->getTicks();
+                    r.level = Warning;
+                    r.tostdout = maylogStdOut(Warning);
+                    r.tofile = maylogFile(Warning);
+                    strcpy(r.module, "Logger");
+                    snprintf(r.text, RecordSize, "Dropped %d log messages of a thread.", dropped - (*it)->reported);
+                    write(r);
+                    written = true;
+                    (*it)->reported = dropped;
+                }
+            }
+            if ( written ) {
+                os::MutexLock lock( inpguard );
+#ifndef OROSEM_PRINTF_LOGGING
+                stdoutput->flush();
+#endif
+#if defined(OROSEM_FILE_LOGGING) && !defined(OROSEM_LOG4CPP_LOGGING) && !defined(OROSEM_PRINTF_LOGGING)
+                logfile.flush();
+#endif
+            }
+        }
+
+        struct Drainer : public base::RunnableInterface
+        {
+            D* d;
+            Drainer(D* d) : d(d) {}
+            bool initialize() { return true; }
+            void step() { d->drain(); }
+            void finalize() {}
+        };
+
+        /** True if the threads queue their messages */
+        bool async;
+        /** The size of the rings which are created */
+        unsigned int records;
+        /** Protects threadlogs */
+        os::Mutex threadlogs_lock;
+        /** The ThreadLogs of all threads that logged asynchronously */
+        std::vector<ThreadLog*> threadlogs;
+        Drainer drainer;
+        Activity* drainer_activity;
+        unsigned int id;
+
+        ~D()
+        {
+            delete drainer_activity;
+            for (std::vector<ThreadLog*>::iterator it = threadlogs.begin(); it != threadlogs.end(); ++it)
+                delete *it;
+        }
     };
 
     Logger::Logger(std::ostream& str)
@@ -415,6 +672,10 @@ namespace RTT
     {
         if ( !d->maylog() )
             return *this;
+        if ( d->async ) {
+            d->threadLog()->setModule( modname.c_str() );
+            return *this;
+        }
         os::MutexLock lock( d->inpguard );
         d->moduleptr = modname.c_str();
         return *this;
@@ -424,6 +685,10 @@ namespace RTT
     {
         if ( !d->maylog() )
             return *this;
+        if ( d->async ) {
+            d->threadLog()->setModule( oldmod.c_str() );
+            return *this;
+        }
         os::MutexLock lock( d->inpguard );
         d->moduleptr = oldmod.c_str();
         return *this;
@@ -432,6 +697,8 @@ namespace RTT
     std::string Logger::getLogModule() const {
         if ( !d->maylog() )
             return "";
+        if ( d->async )
+            return d->threadLog()->record.module;
         os::MutexLock lock( d->inpguard );
         std::string ret = d->moduleptr.c_str();
         return ret;
@@ -494,6 +761,9 @@ namespace RTT
     void Logger::shutdown() {
         if (!d->started)
             return;
+        this->stopAsync();
+        delete d->drainer_activity;
+        d->drainer_activity = 0;
         *this<<Logger::Info<<"Orocos Logging Deactivated." << Logger::endl;
         this->logflush();
         d->started = false;
@@ -515,6 +785,47 @@ namespace RTT
 #endif
     }
 
+    bool Logger::startAsync(unsigned int records) {
+        if ( !d->started || d->async || records == 0 )
+            return false;
+        d->records = records;
+        if ( !d->drainer_activity )
+            d->drainer_activity = new Activity(ORO_SCHED_OTHER, os::LowestPriority, 0.01, &d->drainer, "LoggerDrainer");
+        d->async = true;
+        if ( !d->drainer_activity->start() ) {
+            d->async = false;
+            return false;
+        }
+        return true;
+    }
+
+    void Logger::stopAsync() {
+        if ( !d->async )
+            return;
+        d->drainer_activity->stop();
+        d->async = false;
+        // threads that were queueing still finish their message.
+        d->drain();
+    }
+
+    bool Logger::isAsync() const {
+        return d->async;
+    }
+
+    unsigned int Logger::getDroppedCount() const {
+        os::MutexLock lock( d->threadlogs_lock );
+        unsigned int dropped = 0;
+        for (std::vector<ThreadLog*>::const_iterator it = d->threadlogs.begin(); it != d->threadlogs.end(); ++it)
+            dropped += (*it)->dropped.read();
+        return dropped;
+    }
+
+    std::ostream* Logger::asyncLine() {
+        if ( !d->async )
+            return 0;
+        return &d->threadLog()->line;
+    }
+
     void Logger::setStdStream( std::ostream& stdos ) {
 #ifndef OROSEM_PRINTF_LOGGING
         d->stdoutput = &stdos;
@@ -525,6 +836,11 @@ namespace RTT
         if ( !d->maylog() )
             return *this;
 
+        if ( std::ostream* line = asyncLine() ) {
+            *line << t;
+            return *this;
+        }
+
         os::MutexLock lock( d->inpguard );
         if ( d->maylogStdOut() )
             d->logline << t;
@@ -544,6 +860,10 @@ namespace RTT
     Logger& Logger::operator<<(LogLevel ll) {
         if ( !d->maylog() )
             return *this;
+        if ( d->async ) {
+            d->setLevel(ll);
+            return *this;
+        }
         d->inloglevel = ll;
         return *this;
     }
@@ -558,6 +878,8 @@ namespace RTT
             this->lognl();
         else if ( pf == Logger::flush )
             this->logflush();
+        else if ( std::ostream* line = asyncLine() )
+            *line << pf;
         else {
             os::MutexLock lock( d->inpguard );
             if ( d->maylogStdOut() )
@@ -571,7 +893,7 @@ namespace RTT
     }
 
     void Logger::logflush() {
-        if (!d->maylog())
+        if (!d->maylog() || d->async)
             return;
         {
             // just flush all buffers, do not produce a new logline
@@ -594,12 +916,16 @@ namespace RTT
     void Logger::lognl() {
         if (!d->maylog())
             return;
+        if (d->async)
+            return d->queue();
         d->logit( Logger::nl );
      }
 
     void Logger::logendl() {
         if (!d->maylog())
             return;
+        if (d->async)
+            return d->queue();
         d->logit( Logger::endl );
      }
 
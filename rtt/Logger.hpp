@@ -90,6 +90,10 @@ namespace RTT
      * is 6 or lower, these messages will not appear and do no harm to real-time performance.
      * You need to call @verbatim Logger::log().allowRealTime(); @endverbatim once in your program
      * to confirm this choice. AGAIN: THIS WILL BREAK REAL-TIME PERFORMANCE.
+     *
+     * Alternatively, call startAsync() to have each thread queue its messages
+     * in its own lock-free ring, which a background thread writes to the
+     * output streams. Logging then no longer blocks on the streams.
      * @ingroup CoreLib
      */
     class RTT_API Logger
@@ -241,6 +245,39 @@ namespace RTT
          */
         std::string getLogLine();
 
+        /**
+         * Switch to asynchronous logging. From then on, each thread
+         * formats its messages in a fixed size record, which it queues
+         * in its own lock-free ring of \a records records. A background
+         * thread writes the queued records to the standard output, the
+         * log file and the remote log buffer. Logging then neither
+         * blocks nor allocates memory, except when a thread logs for the
+         * first time, which allocates its ring, or when Logger::In is used.
+         * Messages which do not fit in a record are truncated and messages
+         * logged when the ring is full are dropped and counted.
+         * @param records The number of records in each thread's ring.
+         * @return false if logging was not started or is already
+         * asynchronous.
+         */
+        bool startAsync(unsigned int records = 128);
+
+        /**
+         * Write all queued records and switch back to synchronous
+         * logging.
+         */
+        void stopAsync();
+
+        /**
+         * Returns true if logging is asynchronous.
+         */
+        bool isAsync() const;
+
+        /**
+         * Returns the number of messages that were dropped since the
+         * logger was created, because a thread's ring was full.
+         */
+        unsigned int getDroppedCount() const;
+
         /**
          * Set the standard output stream. (default is cerr).
          */
@@ -329,6 +366,12 @@ namespace RTT
         bool mayLogStdOut() const;
         bool mayLogFile() const;
 
+        /**
+         * Returns the stream which collects the message of the calling
+         * thread in asynchronous mode, or null in synchronous mode.
+         */
+        std::ostream* asyncLine();
+
         Logger(std::ostream& str=std::cerr);
         ~Logger();
 
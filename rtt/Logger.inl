@@ -55,6 +55,11 @@ namespace RTT
         if ( !mayLog() )
             return *this;
 
+        if ( std::ostream* line = asyncLine() ) {
+            *line << t;
+            return *this;
+        }
+
         os::MutexLock lock( inpguard );
         if ( this->mayLogStdOut() )
             logline << t;
@@ -146,6 +151,21 @@ namespace RTT
         return "";
     }
 
+    inline bool Logger::startAsync(unsigned int) {
+        return false;
+    }
+
+    inline void Logger::stopAsync() {
+    }
+
+    inline bool Logger::isAsync() const {
+        return false;
+    }
+
+    inline unsigned int Logger::getDroppedCount() const {
+        return 0;
+    }
+
     inline void Logger::setStdStream( std::ostream& ) {
     }
 
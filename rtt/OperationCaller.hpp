@@ -327,6 +327,20 @@ namespace RTT
             return this->impl && this->impl->ready();
         }
 
+        /**
+         * Reserves the records for \a n outstanding send() calls, such
+         * that send() no longer allocates memory. When \a n sends are
+         * pending, a further send() returns a SendHandle which reports
+         * SendFailure. Call this after the OperationCaller has been
+         * connected to its implementation, since (re-)assigning it
+         * discards the reserved records.
+         * @return false if not ready or if the implementation does not
+         * support it, as is the case for remote operations.
+         */
+        bool reserveSends(unsigned int n) {
+            return this->impl && this->impl->reserveSends(n);
+        }
+
         /**
          * Get the name of this OperationCaller.
          */
@@ -50,6 +50,7 @@
 #include "internal/DataSource.hpp"
 #include "internal/mystd.hpp"
 #include "internal/MWSRQueue.hpp"
+#include "internal/ProfilingService.hpp"
 #include "OperationCaller.hpp"
 
 #include "rtt-config.h"
@@ -111,6 +112,7 @@ namespace RTT
         this->addAttribute("IOCounter",mIOCounter);
         this->addAttribute("TimeOutCounter",mTimeOutCounter);
         this->addAttribute("TriggerCounter",mTriggerCounter);
+        provides()->addService( Service::shared_ptr( new ProfilingService(this) ) );
         // activity runs from the start.
         if (our_act)
             our_act->start();
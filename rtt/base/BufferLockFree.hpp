@@ -42,8 +42,7 @@
 #include "../os/Atomic.hpp"
 #include "../os/CAS.hpp"
 #include "BufferInterface.hpp"
-#include "../internal/AtomicMWSRQueue.hpp"
-#include "../internal/TsPool.hpp"
+#include "../internal/AtomicRingBuffer.hpp"
 #include <vector>
 
 #ifdef ORO_PRAGMA_INTERFACE
@@ -61,6 +60,7 @@ namespace RTT
      * data of type \a T in a FIFO way.
      * No memory allocation is done during read or write.
      * One thread may read and any number of threads may write this buffer.
+     * The samples are stored by value in an internal::AtomicRingBuffer.
      * @param T The value type to be stored in the Buffer.
      * Example : BufferLockFree<A> is a buffer which holds values of type A.
      * @ingroup PortBuffers
@@ -76,42 +76,36 @@ namespace RTT
         typedef T value_t;
     private:
         typedef T Item;
-        internal::AtomicMWSRQueue<Item*> bufs;
-        // is mutable because of reference counting.
-        mutable internal::TsPool<Item> mpool;
+        // multi-reader, since a writer of a circular buffer drops the oldest sample.
+        internal::AtomicRingBuffer<Item> bufs;
         const bool mcircular;
         RTT::os::AtomicInt droppedSamples;
-        
+        Item msample;
+        Item lastSample;
+
     public:
         /**
          * Create a lock-free buffer wich can store \a bufsize elements.
          * @param bufsize the capacity of the buffer.
 '         */
         BufferLockFree( unsigned int bufsize, const T& initial_value = T(), bool circular = false)
-            : bufs( bufsize ), mpool(bufsize + 1), mcircular(circular), droppedSamples(0)
+            : bufs( bufsize, initial_value ), mcircular(circular), droppedSamples(0), msample(initial_value), lastSample(initial_value)
         {
-            mpool.data_sample( initial_value );
         }
 
         ~BufferLockFree() {
-            // free all items still in the buffer.
-            clear();
         }
 
         virtual void data_sample( const T& sample )
         {
-            mpool.data_sample(sample);
+            bufs.data_sample(sample);
+            msample = sample;
+            lastSample = sample;
         }
 
         virtual T data_sample() const
         {
-            T result = T();
-            Item* mitem = mpool.allocate();
-            if (mitem != 0) {
-                result = *mitem;
-                mpool.deallocate( mitem );
-            }
-            return result;
+            return msample;
         }
 
 
@@ -137,123 +131,68 @@ namespace RTT
 
         void clear()
         {
-            Item* item;
-            while ( bufs.dequeue(item) )
-                mpool.deallocate( item );
+            bufs.clear();
         }
 
         virtual size_type dropped() const
         {
             return droppedSamples.read();
         }
-        
+
         bool Push( param_t item)
         {
-            if ( capacity() == (size_type)bufs.size() ) {
-                if (!mcircular) {
-                    droppedSamples.inc();
-                    return false;
-                }
-                // we will recover below in case of circular
-            }
-            Item* mitem = mpool.allocate();
-            if ( mitem == 0 ) { // queue full ( rare but possible in race with PopWithoutRelease )
-                if (!mcircular) {
-                    droppedSamples.inc();
-                    return false;
-                }
-                else {
-                    if (bufs.dequeue( mitem ) == false ) {
-                        droppedSamples.inc();
-                        return false; // assert(false) ???
-                    }
-                    // we keep mitem to write item to next
-                }
+            if ( bufs.enqueue( item ) )
+                return true;
+            if ( !mcircular || capacity() == 0 ) {
+                droppedSamples.inc();
+                return false;
             }
-
-            // copy over.
-            *mitem = item;
-            if (bufs.enqueue( mitem ) == false ) {
-                //got memory, but buffer is full
-                //this can happen, as the memory pool is
-                //bigger than the buffer
-                if (!mcircular) {
-                    mpool.deallocate( mitem );
+            // pop & drop until we have free space.
+            do {
+                if ( bufs.drop( 1 ) )
                     droppedSamples.inc();
-                    return false;
-                } else {
-                    // pop & deallocate until we have free space.
-                    Item* itmp = 0;
-                    do {
-                        if ( bufs.dequeue( itmp ) ) {
-                            mpool.deallocate( itmp );
-                            droppedSamples.inc();
-                        } else {
-                            // Both operations, enqueue() and dequeue() failed on the buffer:
-                            // We could free the allocated pool item return false here,
-                            // but in fact this can only happen during massive concurrent
-                            // access to the circular buffer or in the trivial case that
-                            // the buffer size is zero. So just keep on trying...
-                        }
-                    } while ( bufs.enqueue( mitem ) == false );
-                }
-            }
+            } while ( bufs.enqueue( item ) == false );
             return true;
         }
 
         size_type Push(const std::vector<T>& items)
         {
-            // @todo Make this function more efficient as in BufferLocked.
-            int towrite  = items.size();
-            size_type written = 0;
-            typename std::vector<T>::const_iterator it;
-            for(  it = items.begin(); it != items.end(); ++it) {
-                if ( this->Push( *it ) == false ) {
-                    break; // will only happen in non-circular case !
-                }
-                written++;
+            if ( items.empty() )
+                return 0;
+            size_type written = bufs.enqueue( items.begin(), items.size() );
+            if ( mcircular ) {
+                for ( ; written != size_type(items.size()) && this->Push( items[written] ); ++written)
+                    ;
             }
-            droppedSamples.add(towrite - written);
+            droppedSamples.add(items.size() - written);
             return written;
         }
 
 
         bool Pop( reference_t item )
         {
-            Item* ipop;
-            if (bufs.dequeue( ipop ) == false )
-                return false;
-            item = *ipop;
-            if (mpool.deallocate( ipop ) == false )
-                assert(false);
-            return true;
+            return bufs.dequeue( item );
         }
 
         size_type Pop(std::vector<T>& items )
         {
-            Item* ipop;
-            items.clear();
-            while( bufs.dequeue(ipop) ) {
-                items.push_back( *ipop );
-                if (mpool.deallocate(ipop) == false)
-                    assert(false);
-            }
+            items.resize( bufs.size() );
+            items.resize( bufs.dequeue( items.begin(), items.size() ) );
             return items.size();
         }
-        
+
         value_t* PopWithoutRelease()
-	{
-            Item* ipop;
-            if (bufs.dequeue( ipop ) == false )
+        {
+            if ( bufs.dequeue( lastSample ) == false )
                 return 0;
-	    return ipop;
-	}
+            return &lastSample;
+        }
 
-	void Release(value_t *item) 
-	{
-            if (mpool.deallocate( item ) == false )
-                assert(false);  
-	}
+        void Release(value_t *item)
+        {
+            // the sample is owned by this buffer, nothing to release.
+            assert(item == &lastSample && "Wrong pointer given back to buffer");
+        }
     };
 }}
 
@@ -77,6 +77,10 @@ ExecutionEngine* OperationCallerInterface::getMessageProcessor() const
     return ret;
 }
 
+bool OperationCallerInterface::reserveSends(unsigned int n)
+{
+    return false;
+}
 
 // report an error if an exception was thrown while calling exec()
 void OperationCallerInterface::reportError() {
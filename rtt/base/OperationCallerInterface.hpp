@@ -118,6 +118,14 @@ namespace RTT
 
             ExecutionEngine* getMessageProcessor() const;
 
+            /**
+             * Pre-allocates the records for \a n outstanding send()
+             * calls, such that sending does not allocate memory.
+             * When all records are in use, send() fails with SendFailure.
+             * @return false if this implementation does not support it.
+             */
+            virtual bool reserveSends(unsigned int n);
+
         protected:
             ExecutionEngine* myengine;
             ExecutionEngine* caller;
@@ -43,29 +43,13 @@
 
 
 #include <algorithm>
-
-#ifdef WIN32
-  #include <io.h>
-  #include <fcntl.h>
-  #define pipe(X) _pipe((X), 1024, _O_BINARY)
-  #define close _close
-  #define write _write
-  #undef max
-
-#else
-#include <sys/select.h>
-#include <unistd.h>
-#include <fcntl.h>
 #include <errno.h>
 
-#endif
-
 #include <boost/cstdint.hpp>
 
 using namespace RTT;
 using namespace extras;
 using namespace base;
-const char FileDescriptorActivity::CMD_ANY_COMMAND;
 
 /**
  * Create a FileDescriptorActivity with a given priority and RunnableInterface
@@ -85,11 +69,7 @@ FileDescriptorActivity::FileDescriptorActivity(int priority, RunnableInterface*
     , m_break_loop(false)
     , m_trigger(false)
     , m_user_timeout(false)
-    , m_update_sets(false)
 {
-    FD_ZERO(&m_fd_set);
-    FD_ZERO(&m_fd_work);
-    m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
 }
 
 /**
@@ -111,11 +91,7 @@ FileDescriptorActivity::FileDescriptorActivity(int scheduler, int priority, Runn
     , m_break_loop(false)
     , m_trigger(false)
     , m_user_timeout(false)
-    , m_update_sets(false)
 {
-    FD_ZERO(&m_fd_set);
-    FD_ZERO(&m_fd_work);
-    m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
 }
 
 FileDescriptorActivity::FileDescriptorActivity(int scheduler, int priority, Seconds period, RunnableInterface* _r, const std::string& name )
@@ -128,11 +104,7 @@ FileDescriptorActivity::FileDescriptorActivity(int scheduler, int priority, Seco
     , m_break_loop(false)
     , m_trigger(false)
     , m_user_timeout(false)
-    , m_update_sets(false)
 {
-    FD_ZERO(&m_fd_set);
-    FD_ZERO(&m_fd_work);
-    m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
 }
 
 FileDescriptorActivity::FileDescriptorActivity(int scheduler, int priority, Seconds period, unsigned cpu_affinity, RunnableInterface* _r, const std::string& name )
@@ -145,11 +117,7 @@ FileDescriptorActivity::FileDescriptorActivity(int scheduler, int priority, Seco
     , m_break_loop(false)
     , m_trigger(false)
     , m_user_timeout(false)
-    , m_update_sets(false)
 {
-    FD_ZERO(&m_fd_set);
-    FD_ZERO(&m_fd_work);
-    m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
 }
 
 FileDescriptorActivity::~FileDescriptorActivity()
@@ -190,84 +158,46 @@ void FileDescriptorActivity::setTimeout_us(int timeout_us)
     }
 }
 void FileDescriptorActivity::watch(int fd)
-{ RTT::os::MutexLock lock(m_lock);
+{
     if (fd < 0)
     {
         log(Error) << "negative file descriptor given to FileDescriptorActivity::watch" << endlog();
         return;
     }
-
-    m_watched_fds.insert(fd);
-    FD_SET(fd, &m_fd_set);
-    triggerUpdateSets();
+    m_poller.add(fd);
 }
 void FileDescriptorActivity::unwatch(int fd)
-{ RTT::os::MutexLock lock(m_lock);
-    m_watched_fds.erase(fd);
-    FD_CLR(fd, &m_fd_set);
-    triggerUpdateSets();
-}
+{ m_poller.remove(fd); }
 void FileDescriptorActivity::clearAllWatches()
-{ RTT::os::MutexLock lock(m_lock);
-    m_watched_fds.clear();
-    FD_ZERO(&m_fd_set);
-    triggerUpdateSets();
-}
-void FileDescriptorActivity::triggerUpdateSets()
-{
-    { RTT::os::MutexLock lock(m_command_mutex);
-        m_update_sets = true;
-    }
-    writeInterruptPipe();
-}
+{ m_poller.clear(); }
 bool FileDescriptorActivity::isUpdated(int fd) const
-{ return FD_ISSET(fd, &m_fd_work); }
+{ return m_poller.isReady(fd); }
 bool FileDescriptorActivity::hasError() const
 { return m_has_error; }
 bool FileDescriptorActivity::hasTimeout() const
 { return m_has_timeout; }
 bool FileDescriptorActivity::isWatched(int fd) const
-{ RTT::os::MutexLock lock(m_lock);
-    return FD_ISSET(fd, &m_fd_set); }
+{ return m_poller.isWatched(fd); }
 
 bool FileDescriptorActivity::start()
 {
     if ( isActive() )
         return false;
 
-    if (pipe(m_interrupt_pipe) == -1)
+    if (!m_poller.isOpen())
     {
-        log(Error) << "FileDescriptorActivity: cannot create control pipe" << endlog();
+        log(Error) << "FileDescriptorActivity: cannot wait on file descriptors" << endlog();
         return false;
     }
 
-#ifndef WIN32
-    // set m_interrupt_pipe to non-blocking
-    int flags = 0;
-    if ((flags = fcntl(m_interrupt_pipe[0], F_GETFL, 0)) == -1 ||
-        fcntl(m_interrupt_pipe[0], F_SETFL, flags | O_NONBLOCK) == -1 ||
-        (flags = fcntl(m_interrupt_pipe[1], F_GETFL, 0)) == -1 ||
-        fcntl(m_interrupt_pipe[1], F_SETFL, flags | O_NONBLOCK) == -1)
-    {
-        close(m_interrupt_pipe[0]);
-        close(m_interrupt_pipe[1]);
-        m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
-        log(Error) << "FileDescriptorActivity: could not set the control pipe to non-blocking mode" << endlog();
-        return false;
-    }
-#endif
-
     // reset flags
     m_break_loop = false;
     m_trigger = false;
     m_user_timeout = false;
-    m_update_sets = false;
+    m_poller.clearWakeup();
 
     if (!Activity::start())
     {
-        close(m_interrupt_pipe[0]);
-        close(m_interrupt_pipe[1]);
-        m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
         log(Error) << "FileDescriptorActivity: Activity::start() failed" << endlog();
         return false;
     }
@@ -280,7 +210,7 @@ bool FileDescriptorActivity::trigger()
         { RTT::os::MutexLock lock(m_command_mutex);
             m_trigger = true;
         }
-        writeInterruptPipe();
+        m_poller.wakeup();
         return true;
     } else
         return false;
@@ -292,80 +222,35 @@ bool FileDescriptorActivity::timeout()
         { RTT::os::MutexLock lock(m_command_mutex);
             m_user_timeout = true;
         }
-        writeInterruptPipe();
+        m_poller.wakeup();
         return true;
     } else
         return false;
 }
 
 
-struct fd_watch {
-    int& fd;
-    fd_watch(int& fd) : fd(fd) {}
-    ~fd_watch()
-    {
-        if (fd != -1)
-            close(fd);
-        fd = -1;
-    }
-};
-
 void FileDescriptorActivity::loop()
 {
-    int pipe = m_interrupt_pipe[0];
-    fd_watch watch_pipe_0(m_interrupt_pipe[0]);
-    fd_watch watch_pipe_1(m_interrupt_pipe[1]);
-
     while(true)
     {
-        int max_fd;
-        { RTT::os::MutexLock lock(m_lock);
-            if (m_watched_fds.empty())
-                max_fd = pipe;
-            else
-                max_fd = std::max(pipe, *m_watched_fds.rbegin());
-
-            m_fd_work = m_fd_set;
-        }
-        FD_SET(pipe, &m_fd_work);
-
-        int ret;
         m_running = false;
-        if (m_timeout_us == 0)
-        {
-            ret = select(max_fd + 1, &m_fd_work, NULL, NULL, NULL);
-        }
-        else
-        {
-            static const int USECS_PER_SEC = 1000000;
-            timeval timeout = { m_timeout_us / USECS_PER_SEC,
-                                m_timeout_us % USECS_PER_SEC };
-            ret = select(max_fd + 1, &m_fd_work, NULL, NULL, &timeout);
-        }
+        int ret = m_poller.wait(m_timeout_us);
 
         m_has_error   = false;
         m_has_timeout = false;
         if (ret == -1)
         {
-            log(Error) << "FileDescriptorActivity: error in select(), errno = "
+            log(Error) << "FileDescriptorActivity: error while waiting on file descriptors, errno = "
                        << errno << endlog();
             m_has_error = true;
         }
         else if (ret == 0)
         {
-            log(Error) << "FileDescriptorActivity: timeout in select()" << endlog();
+            log(Error) << "FileDescriptorActivity: timeout while waiting on file descriptors" << endlog();
             m_has_timeout = true;
         }
 
-        // Empty all commands queued in the pipe
-        if (ret > 0 && FD_ISSET(pipe, &m_fd_work)) // breakLoop or trigger requests
-        {
-            // These variables are used in order to loop with select(). See the
-            // while() condition below.
-            clearInterruptPipe();
-        }
-
-        // We check the flags after the command queue was emptied as we could
+        // We check the flags after the poller consumed the wake up as we could
         // miss commands otherwise:
         bool do_trigger = true;
         bool user_trigger = false;
@@ -383,10 +268,6 @@ void FileDescriptorActivity::loop()
                 user_timeout = true;
                 m_user_timeout = false;
             }
-            if (m_update_sets) {
-                m_update_sets = false;
-                do_trigger = false;
-            }
             if (m_break_loop) {
                 m_break_loop = false;
                 break;
@@ -418,36 +299,12 @@ void FileDescriptorActivity::loop()
     }
 }
 
-void FileDescriptorActivity::clearInterruptPipe() {
-    int pipe = m_interrupt_pipe[0];
-
-    fd_set watch_pipe;
-    timeval timeout;
-    char dummy;
-    do
-    {
-        int unused; (void)unused;
-        unused = read(pipe, &dummy, 1);
-
-        // Initialize the values for the next select() call
-        FD_ZERO(&watch_pipe);
-        FD_SET(m_interrupt_pipe[0], &watch_pipe);
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 0;
-    }
-    while (select(pipe + 1, &watch_pipe, NULL, NULL, &timeout) > 0);
-}
-void FileDescriptorActivity::writeInterruptPipe() {
-    int unused; (void)unused; // avoid the "return value not used" warning
-    unused = write(m_interrupt_pipe[1], &CMD_ANY_COMMAND, 1);
-}
-
 bool FileDescriptorActivity::breakLoop()
 {
     { RTT::os::MutexLock lock(m_command_mutex);
         m_break_loop = true;
     }
-    writeInterruptPipe();
+    m_poller.wakeup();
     return true;
 }
 
@@ -475,12 +332,6 @@ bool FileDescriptorActivity::stop()
     // This is bad and will have to be fixed in RTT 2.0 by having delayed stops
     // (i.e. setting the task context's state to FATAL only when loop() has
     // quit)
-    if ( Activity::stop() == true )
-    {
-        fd_watch watch_pipe_0(m_interrupt_pipe[0]);
-        fd_watch watch_pipe_1(m_interrupt_pipe[1]);
-        return true;
-    }
-    return false;
+    return Activity::stop();
 }
 
@@ -40,8 +40,8 @@
 #define FILEDESCRIPTOR_ACTIVITY_HPP
 
 #include "FileDescriptorActivityInterface.hpp"
+#include "FileDescriptorPoller.hpp"
 #include "../Activity.hpp"
-#include <set>
 
 namespace RTT { namespace extras {
 
@@ -100,43 +100,26 @@ namespace RTT { namespace extras {
      *   }
      * }
      * </code>
+     *
+     * The FDs are watched with a FileDescriptorPoller, which uses epoll on
+     * Linux: adding or removing a FD does not wake up the main loop, and the
+     * cost of waiting does not depend on the number of watched FDs.
      */
     class RTT_API FileDescriptorActivity : public extras::FileDescriptorActivityInterface,
                                            public Activity
     {
-        std::set<int> m_watched_fds;
+        /** Watches the FDs and wakes up the main loop */
+        FileDescriptorPoller m_poller;
         bool m_running;
-        int  m_interrupt_pipe[2];
         int  m_timeout_us;		//! timeout in microseconds
         Seconds m_period;		//! intended period
-        /** Lock that protects the access to m_fd_set and m_watched_fds */
-        mutable RTT::os::Mutex m_lock;
-        fd_set m_fd_set;
-        fd_set m_fd_work;
         bool m_has_error;
         bool m_has_timeout;
 
-        static const char CMD_ANY_COMMAND = 0;
         RTT::os::Mutex m_command_mutex;
         bool m_break_loop;
         bool m_trigger;
         bool m_user_timeout;
-        bool m_update_sets;
-
-        /** Internal method that makes sure loop() takes into account
-         * modifications in the set of watched FDs
-         */
-        void triggerUpdateSets();
-
-        /** Internal method that writes on an internal pipe to wake up
-         * the main loop
-         */
-        void writeInterruptPipe();
-
-        /** Internal method that clears the interrupt pipe used to wake
-         * up the main loop
-         */
-        void clearInterruptPipe();
 
     public:
         /**
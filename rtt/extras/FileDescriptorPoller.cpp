@@ -0,0 +1,361 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "FileDescriptorPoller.hpp"
+#include "../os/MutexLock.hpp"
+#include "../Logger.hpp"
+
+#include <algorithm>
+#include <errno.h>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+#elif defined(WIN32)
+  #include <io.h>
+  #include <fcntl.h>
+  #define pipe(X) _pipe((X), 1024, _O_BINARY)
+  #define close _close
+  #define read _read
+  #define write _write
+  #undef max
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+using namespace RTT;
+using namespace extras;
+
+#if defined(__linux__)
+
+FileDescriptorPoller::FileDescriptorPoller()
+    : m_woken(false)
+    , m_epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+    , m_event_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , m_events(16)
+{
+    if (m_epoll_fd != -1 && m_event_fd != -1)
+    {
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = m_event_fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &ev) == 0)
+            return;
+    }
+    log(Error) << "FileDescriptorPoller: cannot create epoll set: " << strerror(errno) << endlog();
+    if (m_epoll_fd != -1)
+        close(m_epoll_fd);
+    if (m_event_fd != -1)
+        close(m_event_fd);
+    m_epoll_fd = m_event_fd = -1;
+}
+
+FileDescriptorPoller::~FileDescriptorPoller()
+{
+    if (m_epoll_fd != -1)
+        close(m_epoll_fd);
+    if (m_event_fd != -1)
+        close(m_event_fd);
+}
+
+bool FileDescriptorPoller::isOpen() const
+{ return m_epoll_fd != -1; }
+
+bool FileDescriptorPoller::add(int fd)
+{ RTT::os::MutexLock lock(m_lock);
+    if (fd < 0 || !isOpen())
+        return false;
+    if (m_watched.count(fd))
+        return true;
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        log(Error) << "FileDescriptorPoller: cannot watch file descriptor " << fd << ": " << strerror(errno) << endlog();
+        return false;
+    }
+    m_watched.insert(fd);
+    return true;
+}
+
+bool FileDescriptorPoller::remove(int fd)
+{ RTT::os::MutexLock lock(m_lock);
+    if (m_watched.erase(fd) == 0)
+        return false;
+    // fails harmlessly if fd was closed already.
+    epoll_event ev;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+    return true;
+}
+
+void FileDescriptorPoller::clear()
+{ RTT::os::MutexLock lock(m_lock);
+    epoll_event ev;
+    for (std::set<int>::const_iterator it = m_watched.begin(); it != m_watched.end(); ++it)
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, *it, &ev);
+    m_watched.clear();
+}
+
+int FileDescriptorPoller::wait(int timeout_us)
+{
+    m_ready.clear();
+    m_woken = false;
+    { RTT::os::MutexLock lock(m_lock);
+        if (m_events.size() < m_watched.size() + 1)
+            m_events.resize(m_watched.size() + 1);
+    }
+
+    int ret;
+    if (timeout_us % 1000 == 0)
+        ret = epoll_wait(m_epoll_fd, &m_events[0], m_events.size(), timeout_us ? timeout_us / 1000 : -1);
+    else
+    {
+        // epoll_wait() only has a millisecond resolution: the epoll
+        // set itself is readable when one of its descriptors is.
+        static const int USECS_PER_SEC = 1000000;
+        pollfd pfd = { m_epoll_fd, POLLIN, 0 };
+        timespec timeout = { timeout_us / USECS_PER_SEC,
+                             (timeout_us % USECS_PER_SEC) * 1000 };
+        ret = ppoll(&pfd, 1, &timeout, 0);
+        if (ret > 0)
+            ret = epoll_wait(m_epoll_fd, &m_events[0], m_events.size(), 0);
+    }
+    if (ret <= 0)
+        return ret;
+
+    for (int i = 0; i != ret; ++i)
+    {
+        if (m_events[i].data.fd == m_event_fd)
+        {
+            m_woken = true;
+            drain();
+        }
+        else
+            m_ready.push_back(m_events[i].data.fd);
+    }
+    std::sort(m_ready.begin(), m_ready.end());
+    return ret;
+}
+
+void FileDescriptorPoller::wakeup()
+{
+    uint64_t one = 1;
+    int unused; (void)unused;
+    unused = write(m_event_fd, &one, sizeof(one));
+}
+
+void FileDescriptorPoller::clearWakeup()
+{
+    drain();
+}
+
+void FileDescriptorPoller::drain()
+{
+    uint64_t count;
+    int unused; (void)unused;
+    unused = read(m_event_fd, &count, sizeof(count));
+}
+
+#else
+
+FileDescriptorPoller::FileDescriptorPoller()
+    : m_woken(false)
+    , m_wakeup(false)
+{
+    FD_ZERO(&m_fd_set);
+    m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
+    if (pipe(m_interrupt_pipe) == -1)
+    {
+        log(Error) << "FileDescriptorPoller: cannot create control pipe" << endlog();
+        return;
+    }
+
+#ifndef WIN32
+    // set m_interrupt_pipe to non-blocking
+    int flags = 0;
+    if ((flags = fcntl(m_interrupt_pipe[0], F_GETFL, 0)) == -1 ||
+        fcntl(m_interrupt_pipe[0], F_SETFL, flags | O_NONBLOCK) == -1 ||
+        (flags = fcntl(m_interrupt_pipe[1], F_GETFL, 0)) == -1 ||
+        fcntl(m_interrupt_pipe[1], F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        close(m_interrupt_pipe[0]);
+        close(m_interrupt_pipe[1]);
+        m_interrupt_pipe[0] = m_interrupt_pipe[1] = -1;
+        log(Error) << "FileDescriptorPoller: could not set the control pipe to non-blocking mode" << endlog();
+    }
+#endif
+}
+
+FileDescriptorPoller::~FileDescriptorPoller()
+{
+    if (m_interrupt_pipe[0] != -1)
+    {
+        close(m_interrupt_pipe[0]);
+        close(m_interrupt_pipe[1]);
+    }
+}
+
+bool FileDescriptorPoller::isOpen() const
+{ return m_interrupt_pipe[0] != -1; }
+
+bool FileDescriptorPoller::add(int fd)
+{
+    if (fd < 0 || fd >= FD_SETSIZE)
+    {
+        log(Error) << "FileDescriptorPoller: cannot watch file descriptor " << fd << endlog();
+        return false;
+    }
+    { RTT::os::MutexLock lock(m_lock);
+        m_watched.insert(fd);
+        FD_SET(fd, &m_fd_set);
+    }
+    interrupt();
+    return true;
+}
+
+bool FileDescriptorPoller::remove(int fd)
+{
+    { RTT::os::MutexLock lock(m_lock);
+        if (m_watched.erase(fd) == 0)
+            return false;
+        FD_CLR(fd, &m_fd_set);
+    }
+    interrupt();
+    return true;
+}
+
+void FileDescriptorPoller::clear()
+{
+    { RTT::os::MutexLock lock(m_lock);
+        m_watched.clear();
+        FD_ZERO(&m_fd_set);
+    }
+    interrupt();
+}
+
+int FileDescriptorPoller::wait(int timeout_us)
+{
+    int pipe = m_interrupt_pipe[0];
+    m_woken = false;
+    while (true)
+    {
+        m_ready.clear();
+        fd_set work;
+        int max_fd;
+        { RTT::os::MutexLock lock(m_lock);
+            if (m_watched.empty())
+                max_fd = pipe;
+            else
+                max_fd = std::max(pipe, *m_watched.rbegin());
+            work = m_fd_set;
+        }
+        FD_SET(pipe, &work);
+
+        int ret;
+        if (timeout_us == 0)
+            ret = select(max_fd + 1, &work, NULL, NULL, NULL);
+        else
+        {
+            static const int USECS_PER_SEC = 1000000;
+            timeval timeout = { timeout_us / USECS_PER_SEC,
+                                timeout_us % USECS_PER_SEC };
+            ret = select(max_fd + 1, &work, NULL, NULL, &timeout);
+        }
+        if (ret <= 0)
+            return ret;
+
+        if (FD_ISSET(pipe, &work))
+        {
+            drain();
+            RTT::os::MutexLock lock(m_lock);
+            m_woken = m_wakeup;
+            m_wakeup = false;
+        }
+        for (int fd = 0; fd <= max_fd; ++fd)
+            if (fd != pipe && FD_ISSET(fd, &work))
+                m_ready.push_back(fd);
+
+        // only the set of watched descriptors changed: wait again.
+        if (m_woken || !m_ready.empty())
+            return m_ready.size() + (m_woken ? 1 : 0);
+    }
+}
+
+void FileDescriptorPoller::interrupt()
+{
+    char c = 0;
+    int unused; (void)unused;
+    unused = write(m_interrupt_pipe[1], &c, 1);
+}
+
+void FileDescriptorPoller::wakeup()
+{
+    { RTT::os::MutexLock lock(m_lock);
+        m_wakeup = true;
+    }
+    interrupt();
+}
+
+void FileDescriptorPoller::clearWakeup()
+{
+    drain();
+    RTT::os::MutexLock lock(m_lock);
+    m_wakeup = false;
+}
+
+void FileDescriptorPoller::drain()
+{
+    int pipe = m_interrupt_pipe[0];
+    char buffer;
+    while (read(pipe, &buffer, 1) > 0)
+    {
+    }
+}
+
+#endif
+
+bool FileDescriptorPoller::isWatched(int fd) const
+{ RTT::os::MutexLock lock(m_lock);
+    return m_watched.count(fd) != 0; }
+
+std::size_t FileDescriptorPoller::size() const
+{ RTT::os::MutexLock lock(m_lock);
+    return m_watched.size(); }
+
+bool FileDescriptorPoller::isReady(int fd) const
+{ return std::binary_search(m_ready.begin(), m_ready.end(), fd); }
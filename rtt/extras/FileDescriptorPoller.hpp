@@ -0,0 +1,159 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_FILEDESCRIPTOR_POLLER_HPP
+#define ORO_FILEDESCRIPTOR_POLLER_HPP
+
+#include "../rtt-config.h"
+#include "../os/Mutex.hpp"
+#include <set>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#elif !defined(WIN32)
+#include <sys/select.h>
+#endif
+
+namespace RTT { namespace extras {
+
+    /**
+     * Waits for input on a set of file descriptors. This is the engine
+     * behind FileDescriptorActivity and the mqueue Dispatcher.
+     *
+     * On Linux, the descriptors are registered once in an epoll set
+     * when they are added, such that the cost of wait() does not depend
+     * on the number of watched descriptors, and wakeup() signals an
+     * eventfd. Other systems fall back to select() and a pipe, in
+     * which case the descriptor values are limited to FD_SETSIZE.
+     *
+     * add(), remove(), clear() and wakeup() may be called from any
+     * thread, but wait() and the functions that inspect its result
+     * must all be called from a single thread.
+     */
+    class RTT_API FileDescriptorPoller
+    {
+        std::set<int> m_watched;
+        std::vector<int> m_ready;
+        /** Lock that protects m_watched (and m_fd_set) */
+        mutable os::Mutex m_lock;
+        bool m_woken;
+#if defined(__linux__)
+        int m_epoll_fd;
+        int m_event_fd;
+        std::vector<epoll_event> m_events;
+#else
+        int m_interrupt_pipe[2];
+        fd_set m_fd_set;
+        /** Set when wakeup() was called, as opposed to a change of m_fd_set */
+        bool m_wakeup;
+        /** Writes on the interrupt pipe */
+        void interrupt();
+#endif
+        /** Reads all pending wake ups from the wake up descriptor */
+        void drain();
+
+        FileDescriptorPoller(FileDescriptorPoller const&);
+        FileDescriptorPoller& operator=(FileDescriptorPoller const&);
+    public:
+        /**
+         * Creates the poller and its wake up descriptor. Check
+         * isOpen() to see if this succeeded.
+         */
+        FileDescriptorPoller();
+
+        ~FileDescriptorPoller();
+
+        /**
+         * Returns true if the poller's own descriptors could be
+         * created.
+         */
+        bool isOpen() const;
+
+        /**
+         * Starts watching \a fd for input.
+         * @return false if \a fd is not a valid descriptor.
+         */
+        bool add(int fd);
+
+        /**
+         * Stops watching \a fd. Once this returns, a next wait() will
+         * not report \a fd anymore.
+         * @return false if \a fd was not watched.
+         */
+        bool remove(int fd);
+
+        /** Stops watching all descriptors. */
+        void clear();
+
+        /** True if \a fd is being watched. */
+        bool isWatched(int fd) const;
+
+        /** The number of watched descriptors. */
+        std::size_t size() const;
+
+        /**
+         * Waits until a watched descriptor has input or an error, until
+         * wakeup() is called or until \a timeout_us microseconds have
+         * passed.
+         * @param timeout_us The timeout in microseconds, or 0 to wait
+         * without timeout.
+         * @return -1 on error (errno is set), 0 on timeout, or else the
+         * number of watched descriptors that are ready, plus one if
+         * the poller was woken up.
+         */
+        int wait(int timeout_us = 0);
+
+        /**
+         * The descriptors which were ready in the last wait(), in
+         * ascending order.
+         */
+        std::vector<int> const& ready() const { return m_ready; }
+
+        /** True if \a fd was ready in the last wait(). */
+        bool isReady(int fd) const;
+
+        /** True if the last wait() returned because of wakeup(). */
+        bool isWoken() const { return m_woken; }
+
+        /**
+         * Makes the current or next wait() return. Wake ups are not
+         * counted: several calls before wait() wake it up once.
+         */
+        void wakeup();
+
+        /** Discards a pending wakeup(). */
+        void clearWakeup();
+    };
+}}
+
+#endif
@@ -0,0 +1,154 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef RTT_LOAN_POOL_HPP
+#define RTT_LOAN_POOL_HPP
+
+#include "ReadOnlyPointer.hpp"
+#include "../internal/AtomicRingBuffer.hpp"
+#include <vector>
+
+namespace RTT
+{ namespace extras {
+
+    /**
+     * A sample of a LoanPool which is being filled in by the writer.
+     * Publishing it turns it into a ReadOnlyPointer which can be written
+     * to an OutputPort< ReadOnlyPointer<T> >. If the sample is destroyed
+     * without being published, it returns to its pool.
+     *
+     * Copies of a LoanedSample refer to the same sample.
+     */
+    template<typename T>
+    class LoanedSample
+    {
+        typedef ROPtrInternal<T> Internal;
+        boost::intrusive_ptr<Internal> internal;
+    public:
+        /** Creates an invalid sample. */
+        LoanedSample() {}
+
+        explicit LoanedSample(Internal* data)
+            : internal(data) {}
+
+        /** False if the pool was exhausted or the sample was published. */
+        bool valid() const { return internal.get() != 0; }
+
+        T& operator*() const { return *internal->value; }
+        T* operator->() const { return internal->value; }
+        T* get() const { return internal ? internal->value : 0; }
+
+        /**
+         * Gives up write access to the sample and returns a read-only,
+         * reference counted view on it. This sample becomes invalid.
+         */
+        ReadOnlyPointer<T> publish()
+        {
+            ReadOnlyPointer<T> result(internal);
+            internal.reset();
+            return result;
+        }
+    };
+
+    /**
+     * A fixed set of pre-allocated samples which are loaned to a writer
+     * and shared read-only by the readers, such that large samples are
+     * passed through ports without copying them.
+     *
+     * The writer loans a sample, fills it in place and writes the published
+     * ReadOnlyPointer to an OutputPort< ReadOnlyPointer<T> >. In-process DATA
+     * and BUFFER connections then only copy the pointer, and readers of an
+     * InputPort< ReadOnlyPointer<T> > get a reference to the same sample. A
+     * sample returns to the pool when the last ReadOnlyPointer to it is gone.
+     *
+     * Connections keep references to the samples they store: the pool must
+     * be able to hold one sample for the writer, one for the port's last written
+     * value, the samples stored by the connections (four per DATA connection,
+     * size + 1 per BUFFER connection) and the samples readers hold on to.
+     * loan() returns an invalid sample when the pool is exhausted.
+     *
+     * Loaning and releasing are lock-free and real-time. The pool must
+     * outlive all samples it loaned.
+     */
+    template<typename T>
+    class LoanPool
+        : public ROPtrOwner<T>
+    {
+        typedef ROPtrInternal<T> Internal;
+        std::vector<T> values;
+        std::vector<Internal*> internals;
+        internal::AtomicRingBuffer<Internal*> free_list;
+    public:
+        /**
+         * Creates a pool of \a size samples, which are initialised with \a sample.
+         */
+        LoanPool(unsigned int size, T const& sample = T())
+            : values(size, sample), internals(size), free_list(size)
+        {
+            for (unsigned int i = 0; i != size; ++i) {
+                internals[i] = new Internal(&values[i], this);
+                free_list.enqueue(internals[i]);
+            }
+        }
+
+        ~LoanPool()
+        {
+            for (unsigned int i = 0; i != internals.size(); ++i)
+                delete internals[i];
+        }
+
+        /**
+         * Takes a free sample from the pool.
+         * @return an invalid sample if all samples are in use.
+         */
+        LoanedSample<T> loan()
+        {
+            Internal* data = 0;
+            if ( !free_list.dequeue(data) )
+                return LoanedSample<T>();
+            return LoanedSample<T>(data);
+        }
+
+        /** The number of samples which can be loaned right now. */
+        unsigned int available() const { return free_list.size(); }
+
+        /** The number of samples in this pool. */
+        unsigned int capacity() const { return internals.size(); }
+
+        virtual void release(Internal* data)
+        {
+            free_list.enqueue(data);
+        }
+    };
+}}
+
+#endif
@@ -48,16 +48,32 @@
 namespace RTT
 { namespace extras {
 
+        template<typename T>
+        struct ROPtrInternal;
+
+        /**
+         * Owner of pre-allocated ROPtrInternal objects and of the values
+         * they refer to, such as a LoanPool. An owned object is handed back
+         * to its owner instead of being deleted when its last reference goes.
+         */
+        template<typename T>
+        struct ROPtrOwner
+        {
+            virtual ~ROPtrOwner() {}
+            virtual void release(ROPtrInternal<T>* data) = 0;
+        };
+
         template<typename T>
         struct ROPtrInternal
         {
             os::Mutex  lock;
             T*     value;
             size_t readers;
+            ROPtrOwner<T>* owner;
 
-            ROPtrInternal(T* value)
-                : value(value), readers(0) {}
-            ~ROPtrInternal() { delete value; }
+            ROPtrInternal(T* value, ROPtrOwner<T>* owner = 0)
+                : value(value), readers(0), owner(owner) {}
+            ~ROPtrInternal() { if (!owner) delete value; }
 
             void ref()
             { os::MutexLock do_lock(lock);
@@ -77,8 +93,12 @@ namespace RTT
         template<typename T>
         void intrusive_ptr_release(ROPtrInternal<T>* data)
         {
-            if (!data->deref())
-                delete data;
+            if (!data->deref()) {
+                if (data->owner)
+                    data->owner->release(data);
+                else
+                    delete data;
+            }
         }
 
     /** Smart pointer that allows safe sharing of data between multiple threads
@@ -105,6 +125,12 @@ namespace RTT
         ReadOnlyPointer(T* ptr = 0)
             : internal(new Internal(ptr)) {}
 
+        /** Shares the value of \a data, which is typically owned
+         * by a LoanPool.
+         */
+        explicit ReadOnlyPointer(boost::intrusive_ptr<Internal> const& data)
+            : internal(data) {}
+
         typename traits::const_reference operator *() const { return *(internal->value); }
         T const* operator ->() const { return internal->value; }
 
@@ -151,7 +177,7 @@ namespace RTT
                 return;
 
             { os::MutexLock do_lock(safe->lock);
-                if (safe->readers == 2) // we are sole owner
+                if (safe->readers == 2 && !safe->owner) // we are sole owner
                 {
                     delete safe->value;
                     safe->value = ptr;
@@ -172,7 +198,7 @@ namespace RTT
          * any copying
          *
          * This method is like write_access, except that it will return NULL if
-         * a copy is needed
+         * a copy is needed, which is always the case for values owned by a LoanPool.
          *
          * If non-NULL, it is the responsibility of the caller to delete the
          * returned value.
@@ -184,7 +210,7 @@ namespace RTT
                 return 0;
 
             { os::MutexLock do_lock(safe->lock);
-                if (safe->readers == 2)
+                if (safe->readers == 2 && !safe->owner)
                 { // we're the only owner (don't forget +safe+ above).
                   // Just promote the current copy
                     T* value = 0;
@@ -204,6 +230,8 @@ namespace RTT
          * done *and* the pointer will be invalidated. Otherwise, the method
          * returns a copy of the pointed-to object.
          *
+         * Values owned by a LoanPool are always copied.
+         *
          * If the copy might be a problem, one can use try_write_access to get
          * the object only when a copy is not needed.
          *
@@ -216,7 +244,7 @@ namespace RTT
                 return 0;
 
             { os::MutexLock do_lock(safe->lock);
-                if (safe->readers == 2)
+                if (safe->readers == 2 && !safe->owner)
                 { // we're the only owner (don't forget +safe+ above).
                   // Just promote the current copy
                     T* value = 0;
@@ -0,0 +1,415 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "ThreadPoolActivity.hpp"
+#include "../os/MutexLock.hpp"
+#include "../os/CAS.hpp"
+#include "../Logger.hpp"
+#include <sstream>
+
+namespace RTT {
+    using namespace extras;
+    using namespace base;
+
+    /**
+     * Executes the queued activities of one ActivityPool until
+     * the pool is destroyed.
+     */
+    class ActivityPool::Worker
+        : public os::Thread
+    {
+        ActivityPool* mpool;
+        unsigned int mindex;
+    public:
+        Worker(ActivityPool* pool, unsigned int index, int scheduler, int priority, const std::string& name)
+            : os::Thread(scheduler, priority, 0.0, 0, name), mpool(pool), mindex(index)
+        {
+        }
+
+        ~Worker()
+        {
+            stop();
+            terminate();
+        }
+
+        void loop()
+        {
+            ThreadPoolActivity* act;
+            while ( (act = mpool->take(mindex)) )
+                act->run(this);
+        }
+
+        bool breakLoop()
+        {
+            // take() returns null once the pool sets mquit.
+            return true;
+        }
+    };
+
+    /**
+     * Queues the periodic activities of one ActivityPool.
+     */
+    class ActivityPool::PeriodTimer
+        : public os::Timer
+    {
+        ActivityPool* mpool;
+    public:
+        PeriodTimer(ActivityPool* pool, int scheduler, int priority, const std::string& name)
+            : os::Timer(0, scheduler, priority, name), mpool(pool)
+        {
+        }
+
+        void timeout(TimerId timer_id)
+        {
+            mpool->expired(timer_id);
+        }
+    };
+
+    ActivityPool::ActivityPool(unsigned int workers, int scheduler, int priority, const std::string& name)
+        : msleepers(0), mquit(false), mtimer(0)
+    {
+        if (workers == 0)
+            workers = 1;
+        for (unsigned int i = 0; i != workers; ++i)
+            mqueues.push_back( new WorkQueue() );
+        for (unsigned int i = 0; i != workers; ++i) {
+            std::stringstream wname;
+            wname << name << "." << i;
+            mworkers.push_back( new Worker(this, i, scheduler, priority, wname.str()) );
+        }
+        for (unsigned int i = 0; i != workers; ++i)
+            mworkers[i]->start();
+        mtimer = new PeriodTimer(this, scheduler, priority, name + ".timer");
+    }
+
+    ActivityPool::~ActivityPool()
+    {
+        delete mtimer;
+        {
+            os::MutexLock lock(mlock);
+            mquit = true;
+            mcond.broadcast();
+        }
+        for (unsigned int i = 0; i != mworkers.size(); ++i)
+            delete mworkers[i];
+        for (unsigned int i = 0; i != mqueues.size(); ++i)
+            delete mqueues[i];
+    }
+
+    unsigned int ActivityPool::getWorkerCount() const
+    {
+        return mworkers.size();
+    }
+
+    os::ThreadInterface* ActivityPool::getWorker(unsigned int i) const
+    {
+        return mworkers.at(i);
+    }
+
+    void ActivityPool::schedule(ThreadPoolActivity* act)
+    {
+        // Keep work which is triggered from a worker on that worker,
+        // others are free to steal it if they are idle.
+        unsigned int q = mworkers.size();
+        for (unsigned int i = 0; i != mworkers.size(); ++i)
+            if ( mworkers[i]->isSelf() ) {
+                q = i;
+                break;
+            }
+        if ( q == mworkers.size() ) {
+            mnext.inc();
+            q = (unsigned int)(mnext.read()) % mworkers.size();
+        }
+        {
+            os::MutexLock lock(mqueues[q]->lock);
+            mqueues[q]->items.push_back(act);
+        }
+        mqueued.inc();
+        if ( msleepers.read() != 0 ) {
+            os::MutexLock lock(mlock);
+            mcond.broadcast();
+        }
+    }
+
+    ThreadPoolActivity* ActivityPool::take(unsigned int i)
+    {
+        WorkQueue& own = *mqueues[i];
+        while (true) {
+            ThreadPoolActivity* act = 0;
+            {
+                os::MutexLock lock(own.lock);
+                if ( !own.items.empty() ) {
+                    act = own.items.back();
+                    own.items.pop_back();
+                }
+            }
+            if ( !act )
+                act = steal(i);
+            if ( act ) {
+                mqueued.dec();
+                return act;
+            }
+            os::MutexLock lock(mlock);
+            if ( mquit )
+                return 0;
+            // schedule() increments mqueued before it reads msleepers,
+            // we do the opposite, so either of us sees the other.
+            msleepers.inc();
+            if ( mqueued.read() <= 0 )
+                mcond.wait(mlock);
+            msleepers.dec();
+        }
+    }
+
+    ThreadPoolActivity* ActivityPool::steal(unsigned int i)
+    {
+        for (unsigned int k = 1; k < mqueues.size(); ++k) {
+            WorkQueue& victim = *mqueues[ (i + k) % mqueues.size() ];
+            os::MutexLock lock(victim.lock);
+            if ( !victim.items.empty() ) {
+                ThreadPoolActivity* act = victim.items.front();
+                victim.items.pop_front();
+                return act;
+            }
+        }
+        return 0;
+    }
+
+    bool ActivityPool::addPeriodic(ThreadPoolActivity* act, Seconds period)
+    {
+        os::MutexLock lock(mtimer_lock);
+        os::Timer::TimerId id = 0;
+        while ( id != int(mtimed.size()) && mtimed[id] != 0 )
+            ++id;
+        if ( id == int(mtimed.size()) ) {
+            mtimed.resize( mtimed.empty() ? 16 : 2 * mtimed.size(), 0 );
+            mtimer->setMaxTimers( mtimed.size() );
+        }
+        if ( !mtimer->startTimer(id, period) )
+            return false;
+        mtimed[id] = act;
+        act->mtimer_id = id;
+        return true;
+    }
+
+    void ActivityPool::removePeriodic(ThreadPoolActivity* act)
+    {
+        os::MutexLock lock(mtimer_lock);
+        if ( act->mtimer_id < 0 )
+            return;
+        mtimer->killTimer(act->mtimer_id);
+        mtimed[act->mtimer_id] = 0;
+        act->mtimer_id = -1;
+    }
+
+    void ActivityPool::expired(os::Timer::TimerId id)
+    {
+        // holding the lock keeps removePeriodic() waiting until we're done.
+        os::MutexLock lock(mtimer_lock);
+        if ( id < int(mtimed.size()) && mtimed[id] )
+            mtimed[id]->request(true);
+    }
+
+    ThreadPoolActivity::ThreadPoolActivity(ActivityPool& pool, Seconds period, RunnableInterface* r)
+        : ActivityInterface(r), mpool(pool), mperiod(period), mactive(false),
+          mstate(Idle), mtimeout(0), mworker(0), mtimer_id(-1)
+    {
+    }
+
+    ThreadPoolActivity::~ThreadPoolActivity()
+    {
+        stop();
+        // A worker may still hold this activity in its queue.
+        os::MutexLock lock(mexecution);
+        while ( mstate != Idle )
+            mdone.wait(mexecution);
+    }
+
+    Seconds ThreadPoolActivity::getPeriod() const
+    {
+        return mperiod;
+    }
+
+    bool ThreadPoolActivity::setPeriod(Seconds s)
+    {
+        if ( s < 0.0 )
+            return false;
+        if ( mactive ) {
+            mpool.removePeriodic(this);
+            if ( s > 0.0 && !mpool.addPeriodic(this, s) )
+                return false;
+        }
+        mperiod = s;
+        return true;
+    }
+
+    unsigned ThreadPoolActivity::getCpuAffinity() const
+    {
+        return ~0;
+    }
+
+    bool ThreadPoolActivity::setCpuAffinity(unsigned cpu)
+    {
+        return false;
+    }
+
+    os::ThreadInterface* ThreadPoolActivity::thread()
+    {
+        os::ThreadInterface* worker = mworker;
+        return worker ? worker : mpool.getWorker(0);
+    }
+
+    bool ThreadPoolActivity::start()
+    {
+        if ( mactive )
+            return false;
+        if ( runner && !runner->initialize() )
+            return false;
+        mactive = true;
+        if ( mperiod > 0.0 && !mpool.addPeriodic(this, mperiod) ) {
+            log(Error) << "ThreadPoolActivity: could not start the timer of period " << mperiod << endlog();
+            mactive = false;
+            if ( runner )
+                runner->finalize();
+            return false;
+        }
+        return true;
+    }
+
+    bool ThreadPoolActivity::stop()
+    {
+        if ( !mactive )
+            return false;
+        mactive = false;
+        mpool.removePeriodic(this);
+        os::ThreadInterface* worker = mworker;
+        if ( worker && worker->isSelf() ) {
+            // stopped from within our own step().
+            if ( runner )
+                runner->finalize();
+        } else {
+            // wait for a running step() to return.
+            os::MutexLock lock(mexecution);
+            if ( runner )
+                runner->finalize();
+        }
+        return true;
+    }
+
+    bool ThreadPoolActivity::isRunning() const
+    {
+        return mactive;
+    }
+
+    bool ThreadPoolActivity::isPeriodic() const
+    {
+        return mperiod > 0.0;
+    }
+
+    bool ThreadPoolActivity::isActive() const
+    {
+        return mactive;
+    }
+
+    bool ThreadPoolActivity::execute()
+    {
+        return false;
+    }
+
+    bool ThreadPoolActivity::trigger()
+    {
+        if ( !mactive )
+            return false;
+        request(false);
+        return true;
+    }
+
+    bool ThreadPoolActivity::timeout()
+    {
+        // a user-timeout is only allowed for non-periodics
+        if ( !mactive || mperiod > 0.0 )
+            return false;
+        request(true);
+        return true;
+    }
+
+    void ThreadPoolActivity::request(bool timed)
+    {
+        if ( timed )
+            mtimeout = 1;
+        while (true) {
+            int state = mstate;
+            if ( state == Idle ) {
+                if ( os::CAS(&mstate, int(Idle), int(Queued)) ) {
+                    mpool.schedule(this);
+                    return;
+                }
+            } else if ( state == Running ) {
+                // run() will queue us again when it's done.
+                if ( os::CAS(&mstate, int(Running), int(Rerun)) )
+                    return;
+            } else {
+                // Queued or Rerun: the pending run will see our request.
+                return;
+            }
+        }
+    }
+
+    void ThreadPoolActivity::run(os::ThreadInterface* worker)
+    {
+        os::MutexLock lock(mexecution);
+        mstate = Running;
+        if ( mactive ) {
+            mworker = worker;
+            bool timed = os::CAS(&mtimeout, 1, 0);
+            if ( runner ) {
+                runner->step();
+                runner->work( timed ? RunnableInterface::TimeOut : RunnableInterface::Trigger );
+            }
+            mworker = 0;
+        }
+        if ( os::CAS(&mstate, int(Running), int(Idle)) ) {
+            mdone.broadcast();
+            return;
+        }
+        // A request came in while we were running. Queue again instead
+        // of looping here, such that a busy component can't starve the
+        // others on this worker.
+        if ( mactive ) {
+            mstate = Queued;
+            mpool.schedule(this);
+        } else {
+            mstate = Idle;
+            mdone.broadcast();
+        }
+    }
+}
@@ -0,0 +1,257 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_THREAD_POOL_ACTIVITY_HPP
+#define ORO_THREAD_POOL_ACTIVITY_HPP
+
+#include "../base/ActivityInterface.hpp"
+#include "../base/RunnableInterface.hpp"
+#include "../os/Thread.hpp"
+#include "../os/Timer.hpp"
+#include "../os/Mutex.hpp"
+#include "../os/Condition.hpp"
+#include "../os/Atomic.hpp"
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace RTT
+{ namespace extras {
+
+    class ThreadPoolActivity;
+
+    /**
+     * @brief A fixed set of worker threads which execute many
+     * ThreadPoolActivity objects.
+     *
+     * Each worker owns a queue of activities that are ready to run.
+     * A worker takes the most recently queued activity from its own
+     * queue and, when that is empty, steals the oldest one from the
+     * queue of another worker. Activities triggered from within a
+     * worker are queued on that same worker, others are spread over the
+     * workers in turn. Periodic activities are timed by one additional
+     * os::Timer thread, which only queues them.
+     *
+     * The pool must outlive all activities that were created with it.
+     * Since a worker is blocked as long as a component blocks in its
+     * hooks, components that wait on each other must not outnumber the
+     * workers.
+     *
+     * @ingroup CoreLibActivities
+     */
+    class RTT_API ActivityPool
+    {
+    public:
+        /**
+         * Create and start a pool of worker threads.
+         * @param workers The number of worker threads. At least one
+         * worker is created.
+         * @param scheduler The scheduler of the workers and the timer thread.
+         * @param priority The priority of the workers and the timer thread.
+         * @param name The name prefix of the threads of this pool.
+         */
+        ActivityPool(unsigned int workers, int scheduler = ORO_SCHED_OTHER,
+                     int priority = os::LowestPriority,
+                     const std::string& name = "ActivityPool");
+
+        /**
+         * Stops and joins all threads of this pool.
+         */
+        ~ActivityPool();
+
+        /**
+         * Returns the number of worker threads.
+         */
+        unsigned int getWorkerCount() const;
+
+        /**
+         * Returns a worker thread of this pool.
+         */
+        os::ThreadInterface* getWorker(unsigned int i) const;
+
+    private:
+        friend class ThreadPoolActivity;
+
+        class Worker;
+        class PeriodTimer;
+
+        struct WorkQueue {
+            os::Mutex lock;
+            std::deque<ThreadPoolActivity*> items;
+        };
+
+        /**
+         * Queue an activity which is ready to run.
+         */
+        void schedule(ThreadPoolActivity* act);
+
+        /**
+         * Returns the next activity to run on worker \a i, or null
+         * when the pool is shutting down.
+         */
+        ThreadPoolActivity* take(unsigned int i);
+
+        ThreadPoolActivity* steal(unsigned int i);
+
+        /**
+         * Let the timer thread queue \a act every \a period seconds.
+         */
+        bool addPeriodic(ThreadPoolActivity* act, Seconds period);
+
+        /**
+         * Stop timing \a act. Once this returns, the timer thread no
+         * longer accesses \a act.
+         */
+        void removePeriodic(ThreadPoolActivity* act);
+
+        /**
+         * Called from the timer thread for timer \a id.
+         */
+        void expired(os::Timer::TimerId id);
+
+        std::vector<Worker*> mworkers;
+        std::vector<WorkQueue*> mqueues;
+        os::AtomicInt mqueued;
+        os::AtomicInt mnext;
+
+        os::Mutex mlock;
+        os::Condition mcond;
+        os::AtomicInt msleepers;
+        bool mquit;
+
+        PeriodTimer* mtimer;
+        os::Mutex mtimer_lock;
+        std::vector<ThreadPoolActivity*> mtimed;
+    };
+
+    /**
+     * @brief An activity which executes its base::RunnableInterface on
+     * one of the worker threads of an ActivityPool.
+     *
+     * This allows to run hundreds of components without giving each of
+     * them an own thread. Like any other activity, it never executes its
+     * runner in two threads at the same time: a trigger() or timeout()
+     * which arrives while the runner is being executed causes one more
+     * execution afterwards, on the same or on another worker.
+     *
+     * \section ExecReact Reactions to execute():
+     * Always returns false.
+     *
+     * \section TrigReact Reactions to trigger():
+     * Queues a work(Trigger) on the pool.
+     *
+     * \section TimeReact Reactions to timeout():
+     * Queues a work(TimeOut) on the pool if the activity is not periodic.
+     * Periodic activities get a work(TimeOut) every period.
+     *
+     * @ingroup CoreLibActivities
+     */
+    class RTT_API ThreadPoolActivity
+        : public base::ActivityInterface
+    {
+    public:
+        /**
+         * Create an activity which is executed by \a pool.
+         * @param pool The pool of workers to execute this activity. It
+         * must outlive this object.
+         * @param period The period in seconds, or zero to only execute on
+         * trigger() and timeout().
+         * @param r The optional runner. If none is given, it is set when
+         * the activity is assigned to a TaskContext.
+         */
+        ThreadPoolActivity(ActivityPool& pool, Seconds period = 0.0,
+                           base::RunnableInterface* r = 0);
+
+        /**
+         * Stops this activity and waits until no worker uses it anymore.
+         */
+        ~ThreadPoolActivity();
+
+        Seconds getPeriod() const;
+
+        bool setPeriod(Seconds s);
+
+        unsigned getCpuAffinity() const;
+
+        bool setCpuAffinity(unsigned cpu);
+
+        /**
+         * Returns the worker which is executing this activity, or the
+         * first worker of the pool if it is not being executed.
+         */
+        os::ThreadInterface* thread();
+
+        bool start();
+
+        bool stop();
+
+        bool isRunning() const;
+
+        bool isPeriodic() const;
+
+        bool isActive() const;
+
+        bool execute();
+
+        bool trigger();
+
+        bool timeout();
+
+    private:
+        friend class ActivityPool;
+
+        enum State { Idle, Queued, Running, Rerun };
+
+        /**
+         * Request an execution, with work(TimeOut) if \a timed.
+         */
+        void request(bool timed);
+
+        /**
+         * Executes this activity once in worker \a worker.
+         */
+        void run(os::ThreadInterface* worker);
+
+        ActivityPool& mpool;
+        Seconds mperiod;
+        volatile bool mactive;
+        volatile int mstate;
+        volatile int mtimeout;
+        os::ThreadInterface* volatile mworker;
+        os::Timer::TimerId mtimer_id;
+        os::Mutex mexecution;
+        os::Condition mdone;
+    };
+
+}}
+
+#endif
@@ -48,6 +48,8 @@ namespace RTT {
         class SimulationActivity;
         class SimulationThread;
         class SlaveActivity;
+        class ThreadPoolActivity;
+        class ActivityPool;
         class TimerThread;
         struct Provider;
         struct RT_INTR;
@@ -57,6 +59,10 @@ namespace RTT {
         class ReadOnlyPointer;
         template<typename T>
         struct ROPtrInternal;
+        template<typename T>
+        class LoanPool;
+        template<typename T>
+        class LoanedSample;
     }
     namespace detail {
         using namespace extras;
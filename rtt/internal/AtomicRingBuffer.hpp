@@ -0,0 +1,360 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_CORELIB_ATOMIC_RING_BUFFER_HPP
+#define ORO_CORELIB_ATOMIC_RING_BUFFER_HPP
+
+#include "../os/CAS.hpp"
+
+namespace RTT
+{
+    namespace internal
+    {
+        /**
+         * A bounded, non-blocking FIFO which stores values of type \a T in
+         * place, in a pre-allocated ring of cells. Each cell carries a sequence
+         * number which tells if it is free or holds a value for the current lap
+         * of the ring, such that writers and readers only need to claim a position
+         * and never hand over pointers. The read and write positions live in
+         * separate cache lines.
+         *
+         * If \a MultiWriter (\a MultiReader) is false, only one thread may
+         * enqueue (dequeue) at a time and positions are claimed without CAS.
+         * Unlike AtomicQueue and AtomicMWSRQueue, any value can be stored,
+         * including null pointers.
+         *
+         * An enqueue or dequeue that races with a slower thread which claimed
+         * the previous position may see the queue as full or empty until that
+         * thread has finished copying its value.
+         *
+         * @param T The value type to be stored in the Queue.
+         * @param MultiWriter Set to false if only one thread enqueues.
+         * @param MultiReader Set to false if only one thread dequeues.
+         * @ingroup CoreLibBuffers
+         */
+        template<class T, bool MultiWriter = true, bool MultiReader = true>
+        class AtomicRingBuffer
+        {
+        public:
+            typedef unsigned int size_type;
+            typedef T value_t;
+
+        private:
+            enum { CacheLineSize = 64 };
+
+            struct Cell
+            {
+                volatile unsigned int seq;
+                T value;
+            };
+
+            /**
+             * A position, alone in its cache line such that writers
+             * and readers do not invalidate each other's cache.
+             */
+            struct Position
+            {
+                volatile unsigned int pos;
+                char pad[CacheLineSize - sizeof(unsigned int)];
+            };
+
+            char _pad0[CacheLineSize];
+            Position _write;
+            Position _read;
+            const size_type _capacity;
+            /** The number of cells, at least one. */
+            const size_type _size;
+            /**
+             * Positions wrap at this value, which is a multiple of _size.
+             */
+            const unsigned int _wrap;
+            Cell* _cells;
+
+            /**
+             * Returns \a p advanced by \a n positions.
+             */
+            unsigned int next(unsigned int p, size_type n) const
+            {
+                p += n;
+                return p >= _wrap ? p - _wrap : p;
+            }
+
+            /**
+             * Returns the sequence number of the cell of position \a p,
+             * when it is free (\a full is false) or holds the value of \a p.
+             */
+            static unsigned int sequence(unsigned int p, bool full)
+            {
+                return 2 * p + (full ? 1 : 0);
+            }
+
+            /**
+             * Returns the signed distance from sequence number \a b to \a a.
+             */
+            int distance(unsigned int a, unsigned int b) const
+            {
+                const unsigned int wrap = 2 * _wrap;
+                unsigned int d = a >= b ? a - b : a + (wrap - b);
+                return d < _wrap ? int(d) : int(d) - int(wrap);
+            }
+
+            Cell& cell(unsigned int p) const
+            {
+                return _cells[p % _size];
+            }
+
+            /**
+             * Sets the sequence number of a cell we own. The CAS
+             * orders the copy of the value before the publication.
+             */
+            static void publish(Cell& c, unsigned int seq)
+            {
+                unsigned int old = c.seq;
+                os::CAS(&c.seq, old, seq);
+            }
+
+            /**
+             * Claims up to \a n consecutive positions from \a position,
+             * of which the cells are free (\a full is false) or hold a value.
+             * @return the number of claimed positions, the first one is stored in \a first.
+             */
+            size_type claim(Position& position, bool multi, bool full, size_type n, unsigned int& first)
+            {
+                if (n > _capacity)
+                    n = _capacity;
+                if (n == 0)
+                    return 0;
+                for (;;) {
+                    unsigned int p = position.pos;
+                    int d = distance( cell(p).seq, sequence(p, full) );
+                    if (d < 0)
+                        return 0; // full or empty.
+                    if (d > 0)
+                        continue; // another thread claimed p.
+                    size_type k = 1;
+                    while ( k < n && cell( next(p, k) ).seq == sequence( next(p, k), full ) )
+                        ++k;
+                    if ( !multi ) {
+                        position.pos = next(p, k);
+                    } else if ( !os::CAS(&position.pos, p, next(p, k)) )
+                        continue;
+                    first = p;
+                    return k;
+                }
+            }
+
+            template<class OutputIterator>
+            size_type pop(OutputIterator items, size_type n, bool store)
+            {
+                size_type done = 0;
+                while (done != n) {
+                    unsigned int first;
+                    size_type k = claim(_read, MultiReader, true, n - done, first);
+                    if (k == 0)
+                        break;
+                    for (size_type i = 0; i != k; ++i) {
+                        unsigned int p = next(first, i);
+                        Cell& c = cell(p);
+                        if (store) {
+                            *items = c.value;
+                            ++items;
+                        }
+                        publish(c, sequence( next(p, _size), false ));
+                    }
+                    done += k;
+                }
+                return done;
+            }
+
+            // non-copyable !
+            AtomicRingBuffer(const AtomicRingBuffer&);
+            AtomicRingBuffer& operator=(const AtomicRingBuffer&);
+        public:
+            /**
+             * Create a queue which can hold \a size elements.
+             * @param size The capacity of the queue.
+             * @param sample The value with which all cells are initialised. Use
+             * it to pre-allocate memory for types such as std::vector.
+             */
+            AtomicRingBuffer(size_type size, const T& sample = T())
+                : _capacity(size), _size(size ? size : 1), _wrap( (0x40000000u / _size) * _size ), _cells( new Cell[_size] )
+            {
+                _write.pos = 0;
+                _read.pos = 0;
+                for (size_type i = 0; i != _size; ++i) {
+                    _cells[i].seq = sequence(i, false);
+                    _cells[i].value = sample;
+                }
+            }
+
+            ~AtomicRingBuffer()
+            {
+                delete[] _cells;
+            }
+
+            /**
+             * Return the maximum number of items this queue can contain.
+             */
+            size_type capacity() const
+            {
+                return _capacity;
+            }
+
+            /**
+             * Return the number of elements in the queue. When other threads
+             * access the queue concurrently, this is an estimate.
+             */
+            size_type size() const
+            {
+                unsigned int r = _read.pos, w = _write.pos;
+                unsigned int d = w >= r ? w - r : w + (_wrap - r);
+                if (d > _wrap / 2) // the read position passed w in the mean time.
+                    return 0;
+                return d > _capacity ? _capacity : d;
+            }
+
+            /**
+             * Inspect if the Queue is empty.
+             */
+            bool isEmpty() const
+            {
+                return size() == 0;
+            }
+
+            /**
+             * Inspect if the Queue is full.
+             */
+            bool isFull() const
+            {
+                return size() == capacity();
+            }
+
+            /**
+             * Enqueue an item.
+             * @param value The value to enqueue.
+             * @return false if queue is full, true if queued.
+             */
+            bool enqueue(const T& value)
+            {
+                return enqueue(&value, 1) == 1;
+            }
+
+            /**
+             * Enqueue up to \a n items with one claim of the write position.
+             * @param items Iterator to the first of \a n items.
+             * @return the number of enqueued items, which is smaller than \a n
+             * if the queue got full.
+             */
+            template<class InputIterator>
+            size_type enqueue(InputIterator items, size_type n)
+            {
+                size_type done = 0;
+                while (done != n) {
+                    unsigned int first;
+                    size_type k = claim(_write, MultiWriter, false, n - done, first);
+                    if (k == 0)
+                        break;
+                    for (size_type i = 0; i != k; ++i, ++items) {
+                        unsigned int p = next(first, i);
+                        Cell& c = cell(p);
+                        c.value = *items;
+                        publish(c, sequence(p, true));
+                    }
+                    done += k;
+                }
+                return done;
+            }
+
+            /**
+             * Dequeue an item.
+             * @param result Stores the dequeued value. It is unchanged when
+             * dequeue returns false and contains the dequeued value
+             * when it returns true.
+             * @return false if queue is empty, true if result was written.
+             */
+            bool dequeue(T& result)
+            {
+                return dequeue(&result, 1) == 1;
+            }
+
+            /**
+             * Dequeue up to \a n items with one claim of the read position.
+             * @param items Output iterator which receives the items.
+             * @return the number of dequeued items.
+             */
+            template<class OutputIterator>
+            size_type dequeue(OutputIterator items, size_type n)
+            {
+                return pop(items, n, true);
+            }
+
+            /**
+             * Dequeue up to \a n items and drop them.
+             * @return the number of dropped items.
+             */
+            size_type drop(size_type n)
+            {
+                return pop( (T*)0, n, false );
+            }
+
+            /**
+             * Return the next to be read value. Only meaningful if no
+             * other thread dequeues concurrently.
+             */
+            const T front() const
+            {
+                return cell(_read.pos).value;
+            }
+
+            /**
+             * Drops all contents of the Queue and thus make it empty.
+             * Items which are being enqueued concurrently may remain.
+             */
+            void clear()
+            {
+                while ( drop(_size) != 0 )
+                    ;
+            }
+
+            /**
+             * Assigns \a sample to all free cells. Only call this if
+             * no other thread accesses the queue.
+             */
+            void data_sample(const T& sample)
+            {
+                for (size_type i = 0; i != _size; ++i)
+                    _cells[i].value = sample;
+            }
+        };
+    }
+}
+#endif
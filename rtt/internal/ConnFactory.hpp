@@ -43,6 +43,7 @@
 #include "Channels.hpp"
 #include "ConnInputEndPoint.hpp"
 #include "ConnOutputEndPoint.hpp"
+#include "SharedChannelElement.hpp"
 #include "../base/PortInterface.hpp"
 #include "../base/InputPortInterface.hpp"
 #include "../base/OutputPortInterface.hpp"
@@ -261,6 +262,69 @@ namespace RTT
             return data_object;
         }
 
+        /**
+         * Builds the output half of a local ConnPolicy::shared connection.
+         * The storage of an existing shared connection of \a output_port is
+         * reused if its policy is compatible, otherwise a new storage is created.
+         * @param output_port The port that will write to the connection.
+         * @param port The input port to which the connection is added.
+         * @param policy The policy dictating which kind of storage must be used.
+         * @return The SharedChannelElement of \a port, which should be connected to
+         * the end of the input-half.
+         */
+        template<typename T>
+        static base::ChannelElementBase::shared_ptr buildSharedChannelOutput(OutputPort<T>& output_port, InputPort<T>& port, ConnPolicy const& policy)
+        {
+            typename SharedChannelStorage<T>::shared_ptr storage;
+            std::list<ConnectionManager::ChannelDescriptor> channels = output_port.getManager()->getChannels();
+            for (std::list<ConnectionManager::ChannelDescriptor>::iterator it = channels.begin(); it != channels.end() && !storage; ++it)
+            {
+                if ( !it->get<2>().shared || !it->get<1>() )
+                    continue;
+                SharedChannelElement<T>* shared = dynamic_cast<SharedChannelElement<T>*>( it->get<1>()->getOutput().get() );
+                if ( shared && shared->getStorage()->accepts(policy) )
+                    storage = shared->getStorage();
+            }
+
+            if (!storage)
+            {
+                if (policy.type == ConnPolicy::DATA)
+                {
+                    typename base::DataObjectInterface<T>::shared_ptr data_object;
+                    switch (policy.lock_policy)
+                    {
+#ifndef OROBLD_OS_NO_ASM
+                    case ConnPolicy::LOCK_FREE:
+                        // all readers may read at the same time.
+                        data_object.reset( new base::DataObjectLockFree<T>(output_port.getLastWrittenValue(), ORONUM_OS_MAX_THREADS) );
+                        break;
+#else
+                    case ConnPolicy::LOCK_FREE:
+                        RTT::log(Warning) << "lock free connection policy is unavailable on this system, defaulting to LOCKED" << RTT::endlog();
+#endif
+                    case ConnPolicy::LOCKED:
+                        data_object.reset( new base::DataObjectLocked<T>(output_port.getLastWrittenValue()) );
+                        break;
+                    case ConnPolicy::UNSYNC:
+                        data_object.reset( new base::DataObjectUnSync<T>(output_port.getLastWrittenValue()) );
+                        break;
+                    }
+                    storage.reset( new SharedDataStorage<T>(policy, data_object) );
+                }
+                else
+                {
+                    if (policy.lock_policy != ConnPolicy::LOCKED)
+                        log(Info) << "Shared buffer connections are always LOCKED." << endlog();
+                    storage.reset( new SharedBufferStorage<T>(policy, output_port.getLastWrittenValue()) );
+                }
+            }
+
+            base::ChannelElementBase::shared_ptr element = new SharedChannelElement<T>(storage, policy);
+            element->setOutput( new ConnOutputEndpoint<T>(&port, output_port.getPortID()) );
+            storage->addReader(element);
+            return element;
+        }
+
         /**
          * Creates a connection from a local output_port to a local or remote input_port.
          * This function contains all logic to decide on how connections must be created to
@@ -291,7 +355,10 @@ namespace RTT
                     return false;
                 }
                 // local ports, create buffer here.
-                output_half = buildBufferedChannelOutput<T>(*input_p, output_port.getPortID(), policy, output_port.getLastWrittenValue());
+                if (policy.shared)
+                    output_half = buildSharedChannelOutput<T>(output_port, *input_p, policy);
+                else
+                    output_half = buildBufferedChannelOutput<T>(*input_p, output_port.getPortID(), policy, output_port.getLastWrittenValue());
             }
             else
             {
@@ -48,6 +48,7 @@
 #include <boost/scoped_ptr.hpp>
 #include "../base/PortInterface.hpp"
 #include "../os/MutexLock.hpp"
+#include "../os/CAS.hpp"
 #include "../base/InputPortInterface.hpp"
 #include <cassert>
 
@@ -60,26 +61,33 @@ namespace RTT
 
         ConnectionManager::ConnectionManager(PortInterface* port)
             : mport(port)
+            , active(0)
             , cur_channel(NULL)
         {
+            snapshots.push_back( new Snapshot() );
+            active = snapshots.front();
         }
 
         ConnectionManager::~ConnectionManager()
         {
             this->disconnect();
+            for (std::vector<Snapshot*>::iterator it = snapshots.begin(); it != snapshots.end(); ++it)
+                delete *it;
         }
 
         /**
          * Helper function to clear a connection.
          * @param descriptor
          */
-        void clearChannel(ConnectionManager::ChannelDescriptor& descriptor) {
+        void clearChannel(ConnectionManager::ChannelDescriptor const& descriptor) {
             descriptor.get<1>()->clear();
         }
 
         void ConnectionManager::clear()
-        { RTT::os::MutexLock lock(connection_lock);
-            std::for_each(connections.begin(), connections.end(), &clearChannel);
+        {
+            Snapshot* snap = lockAndGetActive();
+            std::for_each(snap->channels.begin(), snap->channels.end(), &clearChannel);
+            oro_atomic_dec( &snap->count ); // lockAndGetActive
         }
 
         bool ConnectionManager::findMatchingPort(ConnID const* conn_id, ChannelDescriptor const& descriptor)
@@ -87,12 +95,63 @@ namespace RTT
             return ( descriptor.get<0>() && conn_id->isSameID(*descriptor.get<0>()));
         }
 
-        void ConnectionManager::updateCurrentChannel(bool reset_current)
+        ConnectionManager::Snapshot* ConnectionManager::findEmptySnapshot()
         {
-            if (connections.empty())
-                cur_channel = NULL;
-            else if (reset_current)
-                cur_channel = &(connections.front());
+            for (std::vector<Snapshot*>::iterator it = snapshots.begin(); it != snapshots.end(); ++it)
+                if ( *it != active && oro_atomic_read( &(*it)->count ) == 0 )
+                    return *it;
+            // all snapshots are in use by readers, allocate an additional one.
+            snapshots.push_back( new Snapshot() );
+            return snapshots.back();
+        }
+
+        void ConnectionManager::publish(Snapshot* next)
+        {
+            // a full barrier, such that next->channels is visible before next is.
+            Snapshot* orig = active;
+            os::CAS( &active, orig, next );
+            // Deferred reclamation: drop the references to channels of all snapshots
+            // no reader is traversing any more. Readers that obtain such a snapshot
+            // afterwards will notice that it is not active and retry.
+            for (std::vector<Snapshot*>::iterator it = snapshots.begin(); it != snapshots.end(); ++it)
+                if ( *it != active && oro_atomic_read( &(*it)->count ) == 0 )
+                    (*it)->channels.clear();
+        }
+
+        ConnectionManager::ChannelDescriptor const* ConnectionManager::findCurrent(Snapshot* snap) const
+        {
+            if ( snap->channels.empty() )
+                return NULL;
+            base::ChannelElementBase* current = cur_channel;
+            for (std::vector<ChannelDescriptor>::const_iterator it = snap->channels.begin(); it != snap->channels.end(); ++it)
+                if ( it->get<1>().get() == current )
+                    return &(*it);
+            return &(snap->channels.front());
+        }
+
+        base::ChannelElementBase* ConnectionManager::getCurrentChannel() const
+        {
+            Snapshot* snap = lockAndGetActive();
+            ChannelDescriptor const* descriptor = findCurrent(snap);
+            base::ChannelElementBase* result = descriptor ? descriptor->get<1>().get() : NULL;
+            oro_atomic_dec( &snap->count ); // lockAndGetActive
+            return result;
+        }
+
+        std::list<ConnectionManager::ChannelDescriptor> ConnectionManager::getChannels() const
+        {
+            Snapshot* snap = lockAndGetActive();
+            std::list<ChannelDescriptor> result( snap->channels.begin(), snap->channels.end() );
+            oro_atomic_dec( &snap->count ); // lockAndGetActive
+            return result;
+        }
+
+        bool ConnectionManager::isSingleConnection() const
+        {
+            Snapshot* snap = lockAndGetActive();
+            bool result = snap->channels.size() == 1;
+            oro_atomic_dec( &snap->count ); // lockAndGetActive
+            return result;
         }
 
         bool ConnectionManager::disconnect(PortInterface* port)
@@ -112,11 +171,29 @@ namespace RTT
             return true;
         }
 
+        void ConnectionManager::eraseInvalidChannel(base::ChannelElementBase* channel)
+        {
+            // never block the writer: a later call will retry.
+            if ( !connection_lock.trylock() )
+                return;
+            Snapshot* next = findEmptySnapshot();
+            next->channels.clear();
+            for (std::vector<ChannelDescriptor>::const_iterator it = active->channels.begin(); it != active->channels.end(); ++it)
+                if ( it->get<1>().get() != channel )
+                    next->channels.push_back( *it );
+            if ( next->channels.size() != active->channels.size() )
+                publish(next);
+            connection_lock.unlock();
+        }
+
         void ConnectionManager::disconnect()
         {
-            std::list<ChannelDescriptor> all_connections;
+            std::vector<ChannelDescriptor> all_connections;
             { RTT::os::MutexLock lock(connection_lock);
-                all_connections.splice(all_connections.end(), connections);
+                all_connections = active->channels;
+                Snapshot* next = findEmptySnapshot();
+                next->channels.clear();
+                publish(next);
                 cur_channel = NULL;
             }
             std::for_each(all_connections.begin(), all_connections.end(),
@@ -124,32 +201,43 @@ namespace RTT
         }
 
         bool ConnectionManager::connected() const
-        { return !connections.empty(); }
+        {
+            Snapshot* snap = lockAndGetActive();
+            bool result = !snap->channels.empty();
+            oro_atomic_dec( &snap->count ); // lockAndGetActive
+            return result;
+        }
 
 
         void ConnectionManager::addConnection(ConnID* conn_id, ChannelElementBase::shared_ptr channel, ConnPolicy policy)
         { RTT::os::MutexLock lock(connection_lock);
             assert(conn_id);
             ChannelDescriptor descriptor = boost::make_tuple(conn_id, channel, policy);
-            connections.insert(connections.end(), descriptor);
-            if (connections.size() == 1)
-                cur_channel = &(connections.front());
+            Snapshot* next = findEmptySnapshot();
+            next->channels.reserve( active->channels.size() + 1 );
+            next->channels.assign( active->channels.begin(), active->channels.end() );
+            next->channels.push_back( descriptor );
+            if (next->channels.size() == 1)
+                cur_channel = channel.get();
+            publish(next);
         }
 
         bool ConnectionManager::removeConnection(ConnID* conn_id)
         {
             ChannelDescriptor descriptor;
             { RTT::os::MutexLock lock(connection_lock);
-                std::list<ChannelDescriptor>::iterator conn_it =
-                    std::find_if(connections.begin(), connections.end(), boost::bind(&ConnectionManager::findMatchingPort, this, conn_id, _1));
-                if (conn_it == connections.end())
+                std::vector<ChannelDescriptor>::const_iterator conn_it =
+                    std::find_if(active->channels.begin(), active->channels.end(), boost::bind(&ConnectionManager::findMatchingPort, this, conn_id, _1));
+                if (conn_it == active->channels.end())
                     return false;
                 descriptor = *conn_it;
-                // Verify whether cur_channel is conn_it before we erase, as
-                // cur_channel is a pointer to an element in connections
-                bool reset_current = cur_channel && (cur_channel->get<1>() == descriptor.get<1>());
-                connections.erase(conn_it);
-                updateCurrentChannel(reset_current);
+                Snapshot* next = findEmptySnapshot();
+                next->channels.clear();
+                for (std::vector<ChannelDescriptor>::const_iterator it = active->channels.begin(); it != active->channels.end(); ++it)
+                    if ( it != conn_it )
+                        next->channels.push_back( *it );
+                // a removed current channel is replaced by the first one in findCurrent().
+                publish(next);
             }
 
             // disconnect needs to know if we're from Out->In (forward) or from In->Out
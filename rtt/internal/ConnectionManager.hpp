@@ -51,6 +51,7 @@
 #include "List.hpp"
 #include "../ConnPolicy.hpp"
 #include "../os/Mutex.hpp"
+#include "../os/oro_arch.h"
 #include "../base/rtt-base-fwd.hpp"
 #include "../base/ChannelElementBase.hpp"
 #include <boost/tuple/tuple.hpp>
@@ -60,6 +61,7 @@
 #include <rtt/os/Mutex.hpp>
 #include <rtt/os/MutexLock.hpp>
 #include <list>
+#include <vector>
 
 
 namespace RTT
@@ -71,7 +73,15 @@ namespace RTT
          * Manages connections between ports.
          * This class is used for input and output ports
          * in order to manage their channels.
-         * TODO: use the mutex lock !!!
+         *
+         * The channels are stored in an immutable, contiguous snapshot
+         * which is traversed without taking a lock by write() (delete_if())
+         * and read() (select_reader_channel()). Adding or removing a connection
+         * builds a new snapshot under connection_lock and publishes it
+         * atomically (copy-on-write). Replaced snapshots are recycled only
+         * when no reader refers to them any more, such that the channel elements
+         * of removed connections are released in the updating thread and not in
+         * the real-time data flow.
          */
         class RTT_API ConnectionManager
         {
@@ -114,20 +124,27 @@ namespace RTT
             /** Removes the channel that connects this port to \c port */
             bool disconnect(base::PortInterface* port);
 
+            /**
+             * Calls \a pred for each channel and removes the channels for
+             * which it returned true.
+             * The traversal itself never blocks. Removing the invalidated channels
+             * is only attempted if connection_lock can be taken without waiting,
+             * otherwise they remain in place until the next call.
+             * @return true if \a pred returned true for at least one channel.
+             */
             template<typename Pred>
             bool delete_if(Pred pred) {
-                RTT::os::MutexLock lock(connection_lock);
+                Snapshot* snap = lockAndGetActive();
                 bool result = false;
-                std::list<ChannelDescriptor>::iterator it = connections.begin();
-                while (it != connections.end())
+                for (std::vector<ChannelDescriptor>::const_iterator it = snap->channels.begin(); it != snap->channels.end(); ++it)
                 {
                     if (pred(*it))
                     {
                         result = true;
-                        it = connections.erase(it);
+                        eraseInvalidChannel( it->get<1>().get() );
                     }
-                    else ++it;
                 }
+                oro_atomic_dec( &snap->count ); // lockAndGetActive
                 return result;
             }
 
@@ -141,58 +158,36 @@ namespace RTT
              */
             template<typename Pred>
             void select_reader_channel(Pred pred, bool copy_old_data) {
-                RTT::os::MutexLock lock(connection_lock);
-                ChannelDescriptor *new_channel =
-                    find_if(pred, copy_old_data);
+                Snapshot* snap = lockAndGetActive();
+                ChannelDescriptor const* new_channel =
+                    find_if(snap, pred, copy_old_data);
                 if (new_channel)
                 {
                     // We don't clear the current channel (to get it to NoData state), because there is a race
                     // between find_if and this line. We have to accept (in other parts of the code) that eventually,
                     // all channels return 'OldData'.
-                    cur_channel = new_channel;
+                    cur_channel = new_channel->get<1>().get();
                 }
-            }
-
-            template<typename Pred>
-            ChannelDescriptor *find_if(Pred pred, bool copy_old_data) {
-                // We only copy OldData in the initial read of the current channel.
-                // if it has no new data, the search over the other channels starts,
-                // but no old data is needed.
-                ChannelDescriptor *channel = cur_channel;
-                if ( channel )
-                    if ( pred( copy_old_data, *channel ) )
-                        return channel;
-
-                std::list<ChannelDescriptor>::iterator result;
-                for (result = connections.begin(); result != connections.end(); ++result) {
-                    if (cur_channel && (result->get<1>() == cur_channel->get<1>())) continue;
-                    if ( pred(false, *result) == true)
-                        return &(*result);
-                }
-                return NULL;
+                oro_atomic_dec( &snap->count ); // lockAndGetActive
             }
 
             /**
              * Returns true if this manager manages only one connection.
              * @return
              */
-            bool isSingleConnection() const { return connections.size() == 1; }
+            bool isSingleConnection() const;
 
             /**
              * Returns the first added channel or if select_if was called, the selected channel.
              * @see select_if to change the current channel.
              * @return
              */
-            base::ChannelElementBase* getCurrentChannel() const {
-                return cur_channel ? cur_channel->get<1>().get() : NULL;
-            }
+            base::ChannelElementBase* getCurrentChannel() const;
 
             /**
              * Returns a list of all channels managed by this object.
              */
-            std::list<ChannelDescriptor> getChannels() const {
-                return connections;
-            }
+            std::list<ChannelDescriptor> getChannels() const;
 
             /**
              * Clears (removes) all data in the manager's connections.
@@ -202,21 +197,91 @@ namespace RTT
             void clear();
 
             /**
-             * Locks the mutex protecting the channel element list.
+             * Locks the mutex protecting modifications of the channel element list.
+             * Readers and writers of the port are not blocked by this lock.
              * */
             void lock() const {
                 connection_lock.lock();
             };
 
             /**
-             * Unlocks the mutex protecting the channel element list.
+             * Unlocks the mutex protecting modifications of the channel element list.
              * */
             void unlock() const {
                 connection_lock.unlock();
             }
         protected:
+            /**
+             * An immutable array of channels. It is only modified
+             * while it is not the active snapshot and \a count is zero.
+             */
+            struct Snapshot {
+                Snapshot() { ORO_ATOMIC_SETUP( &count, 0 ); }
+                ~Snapshot() { ORO_ATOMIC_CLEANUP( &count ); }
+                /** The number of readers traversing this snapshot. */
+                mutable oro_atomic_t count;
+                std::vector<ChannelDescriptor> channels;
+            };
 
-            void updateCurrentChannel(bool reset_current);
+            /**
+             * Returns the active snapshot with its reader count increased.
+             * The caller must decrement \a count when done.
+             * @note Always real-time.
+             */
+            Snapshot* lockAndGetActive() const {
+                Snapshot* snap = 0;
+                do {
+                    if (snap)
+                        oro_atomic_dec( &snap->count );
+                    snap = active;
+                    oro_atomic_inc( &snap->count );
+                    // if active changed, snap might be recycled
+                } while ( snap != active );
+                return snap;
+            }
+
+            /**
+             * Returns the descriptor of the current channel in \a snap,
+             * or the first one if the current channel is no longer listed.
+             */
+            ChannelDescriptor const* findCurrent(Snapshot* snap) const;
+
+            template<typename Pred>
+            ChannelDescriptor const* find_if(Snapshot* snap, Pred pred, bool copy_old_data) {
+                // We only copy OldData in the initial read of the current channel.
+                // if it has no new data, the search over the other channels starts,
+                // but no old data is needed.
+                ChannelDescriptor const* channel = findCurrent(snap);
+                if ( channel )
+                    if ( pred( copy_old_data, *channel ) )
+                        return channel;
+
+                std::vector<ChannelDescriptor>::const_iterator result;
+                for (result = snap->channels.begin(); result != snap->channels.end(); ++result) {
+                    if (channel && (result->get<1>() == channel->get<1>())) continue;
+                    if ( pred(false, *result) == true)
+                        return &(*result);
+                }
+                return NULL;
+            }
+
+            /**
+             * Returns a snapshot which is not active and not used by any reader.
+             * Must be called with connection_lock held.
+             */
+            Snapshot* findEmptySnapshot();
+
+            /**
+             * Makes \a next the active snapshot and releases the channels held by
+             * unused snapshots. Must be called with connection_lock held.
+             */
+            void publish(Snapshot* next);
+
+            /**
+             * Removes \a channel from the active snapshot without disconnecting
+             * it, if connection_lock is free. Used by delete_if().
+             */
+            void eraseInvalidChannel(base::ChannelElementBase* channel);
 
             /** Helper method for disconnect(PortInterface*)
              *
@@ -243,19 +308,25 @@ namespace RTT
             base::PortInterface* mport;
 
             /**
-             * A list of all our connections. Only non-null if two or more connections
-             * were added.
+             * All snapshots ever allocated by this manager. They are only
+             * deleted when the manager is destroyed.
+             */
+            std::vector<Snapshot*> snapshots;
+
+            /**
+             * The snapshot that readers and writers traverse.
              */
-            std::list< ChannelDescriptor > connections;
+            Snapshot* volatile active;
 
             /**
-             * Optimisation in case only one channel is to be managed.
+             * The channel that was last selected by a reader. Only used
+             * as a hint, it is looked up in the active snapshot before use.
              */
-            ChannelDescriptor *cur_channel;
+            base::ChannelElementBase* volatile cur_channel;
 
             /**
              * Lock that should be taken before the list of connections is
-             * accessed or modified
+             * modified
              */
             mutable RTT::os::Mutex connection_lock;
         };
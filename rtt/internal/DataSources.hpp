@@ -719,6 +719,22 @@ namespace RTT
         mdsb->reset();
       }
 
+      /**
+       * Returns the DataSource of the first argument.
+       */
+      DataSource<first_arg_t>* getFirst() const
+      {
+          return mdsa.get();
+      }
+
+      /**
+       * Returns the DataSource of the second argument.
+       */
+      DataSource<second_arg_t>* getSecond() const
+      {
+          return mdsb.get();
+      }
+
       virtual BinaryDataSource<function>* clone() const
       {
           return new BinaryDataSource<function>(mdsa.get(), mdsb.get(), fun);
@@ -776,6 +792,14 @@ namespace RTT
         mdsa->reset();
       }
 
+      /**
+       * Returns the DataSource of the argument.
+       */
+      DataSource<arg_t>* getArgument() const
+      {
+          return mdsa.get();
+      }
+
     virtual UnaryDataSource<function>* clone() const
       {
           return new UnaryDataSource<function>(mdsa.get(), fun);
@@ -0,0 +1,162 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "ExecutionProfiler.hpp"
+#include "../os/CAS.hpp"
+#include <cmath>
+
+namespace RTT
+{ namespace internal {
+
+    ExecutionProfiler::ExecutionProfiler()
+        : mtime(os::TimeService::Instance()), mjitter_sum(0.0), mjitter_count(0),
+          mupdate(false), mcycle_start(0), mmark(0), mlast_update(0),
+          mreset(0), mseq(0)
+    {
+        for (int i = 0; i != Phases; ++i)
+            msums[i] = 0.0;
+    }
+
+    void ExecutionProfiler::startCycle(bool update, Seconds period, unsigned int messages,
+                                       unsigned int callbacks, unsigned int functions)
+    {
+        if ( os::CAS(&mreset, 1, 0) ) {
+            mstats = ExecutionStatistics();
+            for (int i = 0; i != Phases; ++i)
+                msums[i] = 0.0;
+            mjitter_sum = 0.0;
+            mjitter_count = 0;
+            mlast_update = 0;
+        }
+        mcycle_start = mmark = mtime->getTicks();
+        mupdate = update;
+
+        ++mstats.cycles;
+        if ( messages > mstats.messages_depth_max )
+            mstats.messages_depth_max = messages;
+        if ( callbacks > mstats.callbacks_depth_max )
+            mstats.callbacks_depth_max = callbacks;
+        if ( functions > mstats.functions_depth_max )
+            mstats.functions_depth_max = functions;
+        if ( !update )
+            return;
+
+        ++mstats.updates;
+        if ( period != mstats.period )
+            mlast_update = 0; // don't measure jitter over a period change
+        mstats.period = period;
+        if ( period <= 0.0 )
+            return;
+        if ( mlast_update != 0 ) {
+            double jitter = std::fabs( Seconds(os::TimeService::ticks2nsecs(mcycle_start - mlast_update)) / 1e9 - period );
+            mjitter_sum += jitter;
+            ++mjitter_count;
+            mstats.jitter_mean = mjitter_sum / mjitter_count;
+            if ( jitter > mstats.jitter_max )
+                mstats.jitter_max = jitter;
+        }
+        mlast_update = mcycle_start;
+    }
+
+    void ExecutionProfiler::endPhase(Phase phase)
+    {
+        ticks now = mtime->getTicks();
+        double duration = Seconds(os::TimeService::ticks2nsecs(now - mmark)) / 1e9;
+        mmark = now;
+        msums[phase] += duration;
+        switch (phase) {
+        case Messages:
+            mstats.messages_mean = msums[phase] / mstats.cycles;
+            if ( duration > mstats.messages_max )
+                mstats.messages_max = duration;
+            break;
+        case Callbacks:
+            mstats.callbacks_mean = msums[phase] / mstats.cycles;
+            if ( duration > mstats.callbacks_max )
+                mstats.callbacks_max = duration;
+            break;
+        case Functions:
+            mstats.functions_mean = msums[phase] / mstats.updates;
+            if ( duration > mstats.functions_max )
+                mstats.functions_max = duration;
+            break;
+        case Hook: {
+            mstats.hook_mean = msums[phase] / mstats.updates;
+            if ( duration > mstats.hook_max )
+                mstats.hook_max = duration;
+            // bin i holds the durations below 2^i microseconds.
+            int bin = 0;
+            for (double limit = 1e-6; duration >= limit && bin != ExecutionStatistics::HistogramBins - 1; limit *= 2.0)
+                ++bin;
+            ++mstats.hook_histogram[bin];
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void ExecutionProfiler::endCycle()
+    {
+        if ( mupdate && mstats.period > 0.0
+             && Seconds(os::TimeService::ticks2nsecs(mtime->getTicks() - mcycle_start)) / 1e9 > mstats.period )
+            ++mstats.overruns;
+
+        // An odd sequence number tells readers that we're writing.
+        // The CAS always succeeds, since we're the only writer, and
+        // acts as a memory barrier.
+        int seq = mseq;
+        os::CAS(&mseq, seq, seq + 1);
+        mpublished = mstats;
+        os::CAS(&mseq, seq + 1, seq + 2);
+    }
+
+    ExecutionStatistics ExecutionProfiler::getStatistics() const
+    {
+        ExecutionStatistics result;
+        while (true) {
+            // read with a barrier by swapping the value with itself.
+            int seq = oro_cmpxchg(&mseq, 0, 0);
+            if ( seq % 2 == 0 ) {
+                result = mpublished;
+                if ( os::CAS(&mseq, seq, seq) )
+                    return result;
+            }
+        }
+    }
+
+    void ExecutionProfiler::reset()
+    {
+        mreset = 1;
+    }
+
+}}
@@ -0,0 +1,113 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_EXECUTION_PROFILER_HPP
+#define ORO_EXECUTION_PROFILER_HPP
+
+#include "../ExecutionStatistics.hpp"
+#include "../os/TimeService.hpp"
+#include "../Time.hpp"
+
+namespace RTT
+{ namespace internal {
+
+    /**
+     * Collects the ExecutionStatistics of one ExecutionEngine.
+     *
+     * The start/end functions may only be called by the thread executing
+     * the engine. They update a private copy of the statistics, which is
+     * published at the end of each cycle with a sequence counter, such
+     * that getStatistics() can read a consistent copy from any thread
+     * without blocking the engine.
+     */
+    class RTT_API ExecutionProfiler
+    {
+    public:
+        enum Phase { Messages, Callbacks, Functions, Hook, Phases };
+
+        ExecutionProfiler();
+
+        /**
+         * Marks the start of a cycle.
+         * @param update true if functions and the updateHook() will be executed.
+         * @param period The period of the activity.
+         * @param messages The number of queued messages.
+         * @param callbacks The number of queued port callbacks.
+         * @param functions The number of running functions.
+         */
+        void startCycle(bool update, Seconds period, unsigned int messages,
+                        unsigned int callbacks, unsigned int functions);
+
+        /**
+         * Marks the end of \a phase, which started at the end of the
+         * previous phase or at the start of the cycle.
+         */
+        void endPhase(Phase phase);
+
+        /**
+         * Marks the end of a cycle and publishes the statistics.
+         */
+        void endCycle();
+
+        /**
+         * Returns the statistics as published at the end of the
+         * last cycle. May be called from any thread.
+         */
+        ExecutionStatistics getStatistics() const;
+
+        /**
+         * Clears the statistics at the start of the next cycle.
+         * May be called from any thread.
+         */
+        void reset();
+
+    private:
+        typedef os::TimeService::ticks ticks;
+
+        os::TimeService* mtime;
+        ExecutionStatistics mstats;
+        double msums[Phases];
+        double mjitter_sum;
+        unsigned int mjitter_count;
+        bool mupdate;
+        ticks mcycle_start;
+        ticks mmark;
+        ticks mlast_update;
+
+        volatile int mreset;
+        mutable volatile int mseq;
+        ExecutionStatistics mpublished;
+    };
+
+}}
+
+#endif
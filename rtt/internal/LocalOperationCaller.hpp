@@ -53,6 +53,8 @@
 #include "OperationCallerBinder.hpp"
 #include <boost/fusion/include/vector_tie.hpp>
 #include "../os/oro_allocator.hpp"
+#include "../os/CAS.hpp"
+#include <vector>
 
 #include <iostream>
 // For doing I/O
@@ -127,6 +129,51 @@ namespace RTT
                 self.reset();
             }
 
+            /**
+             * Pre-allocates \a n call records which are reused by send()
+             * instead of allocating a new one for each call. Once all
+             * records are in use, send() returns a SendHandle which
+             * reports SendFailure. Passing zero restores the default
+             * allocating behaviour. Must not be called concurrently
+             * with send().
+             */
+            virtual bool reserveSends(unsigned int n) {
+                mpool.records.clear();
+                mpool.records.resize(n);
+                for (typename SendPool::Records::iterator it = mpool.records.begin(); it != mpool.records.end(); ++it)
+                    it->record = this->cloneRT();
+                return true;
+            }
+
+            /**
+             * Returns a call record for a new send, either from the
+             * reserved pool or freshly allocated when no pool was reserved.
+             * Returns a null pointer if the pool is exhausted.
+             */
+            shared_ptr sendRecord() {
+                if ( mpool.records.empty() )
+                    return this->cloneRT();
+                for (typename SendPool::Records::iterator it = mpool.records.begin(); it != mpool.records.end(); ++it) {
+                    // A record is free when only the pool refers to it:
+                    // both the SendHandle and self have been released.
+                    if ( it->record.use_count() != 1 || !os::CAS(&it->claimed, 0, 1) )
+                        continue;
+                    shared_ptr cl;
+                    if ( it->record.use_count() == 1 )
+                        cl = it->record;
+                    os::CAS(&it->claimed, 1, 0);
+                    if ( !cl )
+                        continue;
+                    cl->retv.executed = false;
+                    cl->retv.error = false;
+                    cl->myengine = this->myengine;
+                    cl->caller = this->caller;
+                    cl->met = this->met;
+                    return cl;
+                }
+                return shared_ptr();
+            }
+
             SendHandle<Signature> do_send(shared_ptr cl) {
                 //std::cout << "Sending clone..."<<std::endl;
                 ExecutionEngine* receiver = this->getMessageProcessor();
@@ -141,13 +188,18 @@ namespace RTT
             }
             // We need a handle object !
             SendHandle<Signature> send_impl() {
-                return do_send( this->cloneRT() );
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
+                return do_send(cl);
             }
 
             template<class T1>
             SendHandle<Signature> send_impl( T1 a1 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1 );
                 return do_send(cl);
             }
@@ -155,7 +207,9 @@ namespace RTT
             template<class T1, class T2>
             SendHandle<Signature> send_impl( T1 a1, T2 a2 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2 );
                 return do_send(cl);
             }
@@ -163,7 +217,9 @@ namespace RTT
             template<class T1, class T2, class T3>
             SendHandle<Signature> send_impl( T1 a1, T2 a2, T3 a3 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2,a3 );
                 return do_send(cl);
             }
@@ -171,7 +227,9 @@ namespace RTT
             template<class T1, class T2, class T3, class T4>
             SendHandle<Signature> send_impl( T1 a1, T2 a2, T3 a3, T4 a4 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2,a3,a4 );
                 return do_send(cl);
             }
@@ -179,7 +237,9 @@ namespace RTT
             template<class T1, class T2, class T3, class T4, class T5>
             SendHandle<Signature> send_impl( T1 a1, T2 a2, T3 a3, T4 a4, T5 a5 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2,a3,a4,a5 );
                 return do_send(cl);
             }
@@ -187,7 +247,9 @@ namespace RTT
             template<class T1, class T2, class T3, class T4, class T5, class T6>
             SendHandle<Signature> send_impl( T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2,a3,a4,a5,a6 );
                 return do_send(cl);
             }
@@ -195,7 +257,9 @@ namespace RTT
             template<class T1, class T2, class T3, class T4, class T5, class T6, class T7>
             SendHandle<Signature> send_impl( T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7 ) {
                 // bind types from Storage<Function>
-                shared_ptr cl = this->cloneRT();
+                shared_ptr cl = this->sendRecord();
+                if ( !cl )
+                    return SendHandle<Signature>();
                 cl->store( a1,a2,a3,a4,a5,a6,a7 );
                 return do_send(cl);
             }
@@ -624,6 +688,26 @@ namespace RTT
              * were allocated with the rt_allocator class.
              */
             typename base::OperationCallerBase<FunctionT>::shared_ptr self;
+
+            /**
+             * The call records reserved by reserveSends(). Copies of
+             * this object, such as the records themselves, start with
+             * an empty pool.
+             */
+            struct SendPool {
+                struct Slot {
+                    Slot() : claimed(0) {}
+                    shared_ptr record;
+                    volatile int claimed;
+                };
+                typedef std::vector<Slot> Records;
+                Records records;
+
+                SendPool() {}
+                SendPool(SendPool const&) {}
+                SendPool& operator=(SendPool const&) { return *this; }
+            };
+            SendPool mpool;
         };
 
         /**
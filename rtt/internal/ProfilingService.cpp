@@ -0,0 +1,105 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "ProfilingService.hpp"
+#include "../TaskContext.hpp"
+
+namespace RTT
+{ namespace internal {
+
+    ProfilingService::ProfilingService(TaskContext* owner)
+        : Service("profiling", owner), mengine(owner->engine()),
+          mport("statistics"), mpublisher(this), mpublish_period(1.0)
+    {
+        doc("Execution time statistics of this TaskContext.");
+        mport.setDataSample( ExecutionStatistics() );
+        addPort(mport).doc("The execution time statistics, written while profiling is enabled.");
+
+        addOperation("enable", &ProfilingService::enable, this, ClientThread)
+            .doc("Enable or disable profiling of the execution engine.").arg("on", "True to enable.");
+        addOperation("isEnabled", &ProfilingService::isEnabled, this, ClientThread)
+            .doc("Is profiling enabled ?");
+        addOperation("reset", &ProfilingService::reset, this, ClientThread)
+            .doc("Clear the statistics.");
+        addOperation("getStatistics", &ProfilingService::getStatistics, this, ClientThread)
+            .doc("Returns the statistics collected since profiling was enabled or reset.");
+        addOperation("setPublishPeriod", &ProfilingService::setPublishPeriod, this, ClientThread)
+            .doc("Set the minimal time between two writes of the statistics port.").arg("s", "Period in seconds, zero to write after each update.");
+    }
+
+    ProfilingService::~ProfilingService()
+    {
+        mengine->removeUpdateListener(&mpublisher);
+    }
+
+    void ProfilingService::enable(bool on)
+    {
+        mengine->setProfiling(on);
+        if ( on )
+            mengine->addUpdateListener(&mpublisher);
+        else
+            mengine->removeUpdateListener(&mpublisher);
+    }
+
+    bool ProfilingService::isEnabled() const
+    {
+        return mengine->isProfiling();
+    }
+
+    void ProfilingService::reset()
+    {
+        mengine->resetStatistics();
+    }
+
+    ExecutionStatistics ProfilingService::getStatistics() const
+    {
+        return mengine->getStatistics();
+    }
+
+    bool ProfilingService::setPublishPeriod(double period)
+    {
+        if ( period < 0.0 )
+            return false;
+        mpublish_period = period;
+        return true;
+    }
+
+    bool ProfilingService::Publisher::execute()
+    {
+        if ( mlast != 0 && os::TimeService::Instance()->secondsSince(mlast) < mservice->mpublish_period )
+            return true;
+        mlast = os::TimeService::Instance()->getTicks();
+        mservice->mport.write( mservice->mengine->getStatistics() );
+        return true;
+    }
+
+}}
@@ -0,0 +1,95 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_PROFILING_SERVICE_HPP
+#define ORO_PROFILING_SERVICE_HPP
+
+#include "../Service.hpp"
+#include "../OutputPort.hpp"
+#include "../ExecutionStatistics.hpp"
+#include "../base/ExecutableInterface.hpp"
+
+namespace RTT
+{ namespace internal {
+
+    /**
+     * The 'profiling' service of each TaskContext. It switches the
+     * profiling of the TaskContext's ExecutionEngine on and off, returns
+     * its ExecutionStatistics and, while profiling, writes them to the
+     * 'statistics' port after the updateHook().
+     */
+    class RTT_API ProfilingService
+        : public Service
+    {
+    public:
+        ProfilingService(TaskContext* owner);
+
+        ~ProfilingService();
+
+        /**
+         * Enables or disables profiling.
+         */
+        void enable(bool on);
+
+        bool isEnabled() const;
+
+        /**
+         * Clears the statistics.
+         */
+        void reset();
+
+        ExecutionStatistics getStatistics() const;
+
+        /**
+         * Sets the minimal time in seconds between two writes of the
+         * statistics port. Use zero to write after each updateHook().
+         */
+        bool setPublishPeriod(double period);
+
+    private:
+        struct Publisher : public base::ExecutableInterface
+        {
+            ProfilingService* mservice;
+            os::TimeService::ticks mlast;
+            Publisher(ProfilingService* service) : mservice(service), mlast(0) {}
+            bool execute();
+        };
+
+        ExecutionEngine* mengine;
+        OutputPort<ExecutionStatistics> mport;
+        Publisher mpublisher;
+        double mpublish_period;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,375 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef ORO_SHARED_CHANNEL_ELEMENT_HPP
+#define ORO_SHARED_CHANNEL_ELEMENT_HPP
+
+#include "../base/ChannelElement.hpp"
+#include "../base/DataObjectInterface.hpp"
+#include "../os/Atomic.hpp"
+#include "../os/Mutex.hpp"
+#include "../os/MutexLock.hpp"
+#include "../ConnPolicy.hpp"
+#include "List.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+namespace RTT { namespace internal {
+
+    /**
+     * The position of one reader in a SharedChannelStorage.
+     */
+    struct SharedChannelCursor
+    {
+        /** The sequence number of the next sample to read. */
+        unsigned int seq;
+        /** True if the reader has read a sample it can return as OldData. */
+        bool valid;
+        SharedChannelCursor() : seq(0), valid(false) {}
+    };
+
+    /**
+     * Data storage which is shared by all the readers of a ConnPolicy::shared
+     * connection. The writer stores each sample only once and every reader
+     * keeps its own SharedChannelCursor into the storage.
+     *
+     * The storage also keeps track of its readers, such that the channel of
+     * only one reader (the 'writer' element) stores the sample and signals all
+     * the others.
+     */
+    template<typename T>
+    class SharedChannelStorage
+    {
+    public:
+        typedef boost::shared_ptr< SharedChannelStorage<T> > shared_ptr;
+        typedef typename base::ChannelElement<T>::param_t param_t;
+        typedef typename base::ChannelElement<T>::reference_t reference_t;
+
+        SharedChannelStorage(ConnPolicy const& policy)
+            : mpolicy(policy), mreaders(0), mwriter(0) {}
+
+        virtual ~SharedChannelStorage() {}
+
+        /**
+         * Returns true if a connection with \a policy can use this storage.
+         */
+        bool accepts(ConnPolicy const& policy) const
+        {
+            return policy.shared && policy.type == mpolicy.type
+                && policy.lock_policy == mpolicy.lock_policy
+                && (policy.type == ConnPolicy::DATA || policy.size == mpolicy.size);
+        }
+
+        /** Stores a new sample. */
+        virtual void write(param_t sample) = 0;
+
+        /**
+         * Reads the sample at \a cursor and advances it.
+         */
+        virtual FlowStatus read(SharedChannelCursor& cursor, reference_t sample, bool copy_old_data) = 0;
+
+        /**
+         * Returns the sequence number of the next sample that will be written.
+         */
+        virtual unsigned int head() const = 0;
+
+        virtual void data_sample(param_t sample) = 0;
+
+        virtual T data_sample() const = 0;
+
+        /**
+         * Returns a cursor for a new reader. If \a init is set, the last
+         * written sample (if any) is returned as NewData by the first read.
+         */
+        SharedChannelCursor newCursor(bool init) const
+        {
+            SharedChannelCursor cursor;
+            cursor.seq = this->head();
+            if (init && cursor.seq != 0)
+                --cursor.seq;
+            return cursor;
+        }
+
+        /**
+         * Adds a reader's channel element. The first reader becomes the
+         * element that stores samples.
+         * @note Not real-time.
+         */
+        void addReader(base::ChannelElementBase::shared_ptr reader)
+        {
+            os::MutexLock lock(mreaders_lock);
+            mreaders.grow(1);
+            mreaders.append(reader);
+            if (mwriter == 0)
+                mwriter = reader.get();
+        }
+
+        /**
+         * Removes a reader's channel element. If it was the element that
+         * stores samples, another reader takes over.
+         * @note Not real-time.
+         */
+        void removeReader(base::ChannelElementBase* reader)
+        {
+            os::MutexLock lock(mreaders_lock);
+            if ( !mreaders.erase( base::ChannelElementBase::shared_ptr(reader) ) )
+                return;
+            mreaders.shrink(1);
+            if (mwriter == reader)
+                mwriter = mreaders.empty() ? 0 : mreaders.front().get();
+        }
+
+        /**
+         * Returns true if \a element must store the samples written
+         * to the connection.
+         */
+        bool isWriter(base::ChannelElementBase const* element) const { return mwriter == element; }
+
+        /**
+         * Signals all readers that new data is available.
+         */
+        void signalReaders()
+        {
+            mreaders.apply( &SharedChannelStorage<T>::signalReader );
+        }
+
+        /** The number of readers attached to this storage. */
+        size_t readers() const { return mreaders.size(); }
+
+        ConnPolicy const& getPolicy() const { return mpolicy; }
+
+    private:
+        static void signalReader(base::ChannelElementBase::shared_ptr const& reader)
+        {
+            reader->signal();
+        }
+
+        ConnPolicy mpolicy;
+        List<base::ChannelElementBase::shared_ptr> mreaders;
+        base::ChannelElementBase* volatile mwriter;
+        os::Mutex mreaders_lock;
+    };
+
+    /**
+     * Shared storage for DATA connections. The data object is selected
+     * according to the connection's lock policy.
+     */
+    template<typename T>
+    class SharedDataStorage : public SharedChannelStorage<T>
+    {
+        typename base::DataObjectInterface<T>::shared_ptr data;
+        os::AtomicInt seq;
+    public:
+        typedef typename SharedChannelStorage<T>::param_t param_t;
+        typedef typename SharedChannelStorage<T>::reference_t reference_t;
+
+        SharedDataStorage(ConnPolicy const& policy, typename base::DataObjectInterface<T>::shared_ptr data_object)
+            : SharedChannelStorage<T>(policy), data(data_object), seq(0) {}
+
+        virtual void write(param_t sample)
+        {
+            data->Set(sample);
+            seq.inc();
+        }
+
+        virtual FlowStatus read(SharedChannelCursor& cursor, reference_t sample, bool copy_old_data)
+        {
+            unsigned int current = seq.read();
+            if (current != cursor.seq) {
+                data->Get(sample);
+                cursor.seq = current;
+                cursor.valid = true;
+                return NewData;
+            }
+            if (cursor.valid) {
+                if (copy_old_data)
+                    data->Get(sample);
+                return OldData;
+            }
+            return NoData;
+        }
+
+        virtual unsigned int head() const { return seq.read(); }
+
+        virtual void data_sample(param_t sample) { data->data_sample(sample); }
+
+        virtual T data_sample() const { return data->Get(); }
+    };
+
+    /**
+     * Shared storage for BUFFER and CIRCULAR_BUFFER connections.
+     * It is a ring of policy.size samples which is never full for the
+     * writer: a reader that falls more than size samples behind loses its
+     * oldest samples, as with a circular buffer. Readers copy the sample out
+     * of the ring while holding a lock, such that the writer can not
+     * overwrite it in the mean time.
+     */
+    template<typename T>
+    class SharedBufferStorage : public SharedChannelStorage<T>
+    {
+        std::vector<T> ring;
+        unsigned int mhead;
+        os::AtomicInt droppedSamples;
+        mutable os::Mutex lock;
+    public:
+        typedef typename SharedChannelStorage<T>::param_t param_t;
+        typedef typename SharedChannelStorage<T>::reference_t reference_t;
+
+        SharedBufferStorage(ConnPolicy const& policy, T const& initial_value)
+            : SharedChannelStorage<T>(policy), ring(policy.size > 0 ? policy.size : 1, initial_value), mhead(0) {}
+
+        virtual void write(param_t sample)
+        {
+            os::MutexLock locker(lock);
+            ring[mhead % ring.size()] = sample;
+            ++mhead;
+        }
+
+        virtual FlowStatus read(SharedChannelCursor& cursor, reference_t sample, bool copy_old_data)
+        {
+            os::MutexLock locker(lock);
+            if (mhead - cursor.seq > ring.size()) {
+                droppedSamples.add( mhead - cursor.seq - ring.size() );
+                cursor.seq = mhead - ring.size();
+            }
+            if (cursor.seq != mhead) {
+                sample = ring[cursor.seq % ring.size()];
+                ++cursor.seq;
+                cursor.valid = true;
+                return NewData;
+            }
+            if (cursor.valid) {
+                // the last read sample may have been overwritten by now.
+                if (copy_old_data && mhead - (cursor.seq - 1) <= ring.size())
+                    sample = ring[(cursor.seq - 1) % ring.size()];
+                return OldData;
+            }
+            return NoData;
+        }
+
+        virtual unsigned int head() const
+        {
+            os::MutexLock locker(lock);
+            return mhead;
+        }
+
+        virtual void data_sample(param_t sample)
+        {
+            os::MutexLock locker(lock);
+            ring.assign(ring.size(), sample);
+        }
+
+        virtual T data_sample() const
+        {
+            os::MutexLock locker(lock);
+            return ring.front();
+        }
+
+        /** The number of samples lost by lagging readers. */
+        size_t dropped() const { return droppedSamples.read(); }
+    };
+
+    /**
+     * The per-reader channel element of a ConnPolicy::shared connection.
+     * Each reader has its own element and cursor, but all elements of
+     * compatible connections of one output port refer to the same
+     * SharedChannelStorage. Only one of them stores a written sample, such
+     * that a write costs one copy, independent of the number of readers.
+     */
+    template<typename T>
+    class SharedChannelElement : public base::ChannelElement<T>
+    {
+        typename SharedChannelStorage<T>::shared_ptr storage;
+        SharedChannelCursor cursor;
+    public:
+        typedef typename base::ChannelElement<T>::param_t param_t;
+        typedef typename base::ChannelElement<T>::reference_t reference_t;
+
+        SharedChannelElement(typename SharedChannelStorage<T>::shared_ptr storage, ConnPolicy const& policy)
+            : storage(storage), cursor(storage->newCursor(policy.init)) {}
+
+        typename SharedChannelStorage<T>::shared_ptr getStorage() const { return storage; }
+
+        /**
+         * Stores the sample and signals all readers if this element is
+         * the storage's writer, does nothing otherwise.
+         */
+        virtual bool write(param_t sample)
+        {
+            if ( !storage->isWriter(this) )
+                return true;
+            storage->write(sample);
+            storage->signalReaders();
+            return true;
+        }
+
+        virtual FlowStatus read(reference_t sample, bool copy_old_data)
+        {
+            return storage->read(cursor, sample, copy_old_data);
+        }
+
+        /** Skips all samples written so far. After clear() has been called,
+         * read() returns NoData until a new sample is written.
+         */
+        virtual void clear()
+        {
+            cursor.seq = storage->head();
+            cursor.valid = false;
+            base::ChannelElement<T>::clear();
+        }
+
+        virtual bool data_sample(param_t sample)
+        {
+            if ( storage->isWriter(this) )
+                storage->data_sample(sample);
+            return base::ChannelElement<T>::data_sample(sample);
+        }
+
+        virtual T data_sample()
+        {
+            return storage->data_sample();
+        }
+
+        virtual void disconnect(bool forward)
+        {
+            storage->removeReader(this);
+            base::ChannelElement<T>::disconnect(forward);
+        }
+
+        virtual std::string getElementName() const
+        {
+            return "SharedChannelElement";
+        }
+    };
+}}
+
+#endif
@@ -46,6 +46,7 @@ namespace RTT {
         class ConnectionBase;
         class ConnectionManager;
         class DataSourceCommand;
+        class ExecutionProfiler;
         class GlobalEngine;
         class OffsetDataSource;
         class OperationCallerC;
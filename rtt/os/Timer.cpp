@@ -41,7 +41,6 @@
 #include "../Activity.hpp"
 #include "../Logger.hpp"
 #include "../os/fosi.h"
-#include <limits>
 
 namespace RTT {
     using namespace base;
@@ -62,70 +61,55 @@ namespace RTT {
     {
         // This code is executed from mThread's thread
         while (!mdo_quit) {
-            Time wake_up_time;
             TimerId next_timer_id = 0;
 
-            // Select next timer.
-            int ret = 0;
             {// This scope is for MutexLock.
-                // find wake_up_time
-                // check timers queue.
                 MutexLock locker(mmutex);
-                wake_up_time = std::numeric_limits<Time>::max();
-                for (TimerIds::iterator it = mtimers.begin(); it != mtimers.end(); ++it) {
-                    if ( it->expires != 0 && it->expires < wake_up_time  ) {
-                        wake_up_time = it->expires;
-                        next_timer_id = it - mtimers.begin();
-                    }
+                if ( mdo_quit )
+                    break;
+                // the next timer to expire is on top of the heap.
+                if ( mheap.empty() ) {
+                    mcond.wait( mmutex ); // case of no timers
+                    continue;
+                }
+                next_timer_id = mheap.front();
+                TimerInfo& tim = mtimers[next_timer_id];
+                if ( tim.expires > rtos_get_time_ns() ) {
+                    // case of running timers. Since timers may be armed
+                    // or killed meanwhile, select again after waking up.
+                    mcond.wait_until( mmutex, tim.expires );
+                    continue;
                 }
 
-                // Wait
-                if ( wake_up_time == std::numeric_limits<Time>::max() )
-                    ret = mcond.wait( mmutex ); // case of no timers
-                else if ( wake_up_time > rtos_get_time_ns() )
-                    ret = mcond.wait_until( mmutex, wake_up_time ); // case of running timers
-                else
-                    ret = -1; // case of timer overrun.
-            }// MutexLock
-
-            // Timeout handling
-            if (ret == -1) {
-                // a timer expired
-                // expires: reset/reprogram the timer that expired:
-                {
-                    MutexLock locker(mmutex);
-                    // detect corner case for resize:
-                    if ( next_timer_id < int(mtimers.size()) ) {
-                        // now clear or reprogram it.
-                        TimerIds::iterator tim = mtimers.begin() + next_timer_id;
-                        if ( tim->period ) {
-                            // periodic timer
-                            tim->expires += tim->period;
-                        } else {
-                            // aperiodic timer
-                            tim->expires = 0;
-                        }
-                    }
+                // a timer expired or overran: reset/reprogram it.
+                if ( tim.period ) {
+                    // periodic timer
+                    tim.expires += tim.period;
+                    schedule( next_timer_id );
+                } else {
+                    // aperiodic timer
+                    tim.expires = 0;
+                    unschedule( next_timer_id );
                 }
 
-                // Second: notify waiting threads
-                {// This scope is for MutexLock.
-                    MutexLock locker(mmutex);
-                    mtimers[next_timer_id].expired.broadcast();
-                }// MutexLock
-
-                // Third: send the timeout signal and allow (within the callback)
-                // to reprogram the timer.
-                // If we would expires call timeout(), the code above would overwrite
-                // user settings.
-                timeout( next_timer_id );
-            }
+                // notify waiting threads
+                tim.expired.broadcast();
+            }// MutexLock
+
+            // Send the timeout signal and allow (within the callback)
+            // to reprogram the timer.
+            // If we would expires call timeout(), the code above would overwrite
+            // user settings.
+            timeout( next_timer_id );
         }
     }
 
     bool Timer::breakLoop()
     {
-        mdo_quit = true;
+        {
+            MutexLock locker(mmutex);
+            mdo_quit = true;
+        }
         mcond.broadcast();
         // kill all timers to abort all threads blocking in waitFor()
         for (TimerId i = 0; i < (int) mtimers.size(); ++i) {
@@ -138,6 +122,7 @@ namespace RTT {
         : mThread(0), mdo_quit(false)
     {
         mtimers.resize(max_timers);
+        mheap.reserve(max_timers);
         if (scheduler != -1) {
             mThread = new Activity(scheduler, priority, 0.0, this, name);
             mThread->start();
@@ -158,7 +143,78 @@ namespace RTT {
     void Timer::setMaxTimers(TimerId max)
     {
         MutexLock locker(mmutex);
+        for (TimerId i = max; i < int(mtimers.size()); ++i)
+            unschedule(i);
         mtimers.resize(max, TimerInfo() );
+        mheap.reserve(max);
+    }
+
+    bool Timer::expiresBefore(TimerId a, TimerId b) const
+    {
+        // equal expiry times are ordered by id, like the former linear search did.
+        return mtimers[a].expires < mtimers[b].expires
+            || ( mtimers[a].expires == mtimers[b].expires && a < b );
+    }
+
+    void Timer::heapSet(int pos, TimerId timer_id)
+    {
+        mheap[pos] = timer_id;
+        mtimers[timer_id].heap_pos = pos;
+    }
+
+    void Timer::siftUp(int pos)
+    {
+        TimerId timer_id = mheap[pos];
+        while ( pos > 0 ) {
+            int parent = (pos - 1) / 2;
+            if ( !expiresBefore(timer_id, mheap[parent]) )
+                break;
+            heapSet(pos, mheap[parent]);
+            pos = parent;
+        }
+        heapSet(pos, timer_id);
+    }
+
+    void Timer::siftDown(int pos)
+    {
+        TimerId timer_id = mheap[pos];
+        int size = mheap.size();
+        while ( 2 * pos + 1 < size ) {
+            int child = 2 * pos + 1;
+            if ( child + 1 < size && expiresBefore(mheap[child + 1], mheap[child]) )
+                ++child;
+            if ( !expiresBefore(mheap[child], timer_id) )
+                break;
+            heapSet(pos, mheap[child]);
+            pos = child;
+        }
+        heapSet(pos, timer_id);
+    }
+
+    void Timer::schedule(TimerId timer_id)
+    {
+        if ( mtimers[timer_id].heap_pos < 0 ) {
+            mheap.push_back( timer_id );
+            siftUp( mheap.size() - 1 );
+        } else {
+            siftUp( mtimers[timer_id].heap_pos );
+            siftDown( mtimers[timer_id].heap_pos );
+        }
+    }
+
+    void Timer::unschedule(TimerId timer_id)
+    {
+        int pos = mtimers[timer_id].heap_pos;
+        if ( pos < 0 )
+            return;
+        mtimers[timer_id].heap_pos = -1;
+        TimerId last = mheap.back();
+        mheap.pop_back();
+        if ( last != timer_id ) {
+            heapSet(pos, last);
+            siftUp(pos);
+            siftDown(mtimers[last].heap_pos);
+        }
     }
 
     bool Timer::startTimer(TimerId timer_id, double period)
@@ -170,13 +226,18 @@ namespace RTT {
         }
 
         Time due_time = rtos_get_time_ns() + Seconds_to_nsecs( period );
+        bool first;
 
         {
             MutexLock locker(mmutex);
             mtimers[timer_id].expires = due_time;
             mtimers[timer_id].period = Seconds_to_nsecs( period );
+            schedule( timer_id );
+            first = mtimers[timer_id].heap_pos == 0;
         }
-        mcond.broadcast();
+        // only wake up the loop if this timer expires first.
+        if ( first )
+            mcond.broadcast();
         return true;
     }
 
@@ -190,13 +251,18 @@ namespace RTT {
 
         Time now = rtos_get_time_ns();
         Time due_time = now + Seconds_to_nsecs( wait_time );
+        bool first;
 
         {
             MutexLock locker(mmutex);
             mtimers[timer_id].expires  = due_time;
             mtimers[timer_id].period = 0;
+            schedule( timer_id );
+            first = mtimers[timer_id].heap_pos == 0;
         }
-        mcond.broadcast();
+        // only wake up the loop if this timer expires first.
+        if ( first )
+            mcond.broadcast();
         return true;
     }
 
@@ -235,6 +301,7 @@ namespace RTT {
             log(Error) << "Invalid timer id" << endlog();
             return false;
         }
+        unschedule( timer_id );
         mtimers[timer_id].expires = 0;
         mtimers[timer_id].period = 0;
         mtimers[timer_id].expired.broadcast();
@@ -81,11 +81,12 @@ namespace RTT
 
         struct TimerInfo
         {
-            TimerInfo() : expires(0), period(0) {}
+            TimerInfo() : expires(0), period(0), heap_pos(-1) {}
             TimerInfo(const TimerInfo& other) { *this = other; }
-            TimerInfo& operator=(const TimerInfo& other) { this->expires = other.expires; this->period = other.period; return *this; }
+            TimerInfo& operator=(const TimerInfo& other) { this->expires = other.expires; this->period = other.period; this->heap_pos = other.heap_pos; return *this; }
             Time expires; // was .first
             Time period;  // was .second
+            int heap_pos; // position in mheap or -1 if not armed.
             Condition expired;
         };
 
@@ -96,8 +97,34 @@ namespace RTT
          */
         typedef std::vector<TimerInfo> TimerIds;
         TimerIds mtimers;
+
+        /**
+         * Binary min-heap of the ids of the armed timers, ordered by
+         * their expiry time, such that the loop() finds the next timer
+         * to expire in constant time and arming or killing a timer
+         * takes logarithmic time.
+         */
+        typedef std::vector<TimerId> TimerHeap;
+        TimerHeap mheap;
         bool mdo_quit;
 
+        /**
+         * (Re-)inserts \a timer_id in mheap after its expiry time changed.
+         * Must be called with mmutex locked.
+         */
+        void schedule(TimerId timer_id);
+
+        /**
+         * Removes \a timer_id from mheap if it is armed.
+         * Must be called with mmutex locked.
+         */
+        void unschedule(TimerId timer_id);
+
+        bool expiresBefore(TimerId a, TimerId b) const;
+        void heapSet(int pos, TimerId timer_id);
+        void siftUp(int pos);
+        void siftDown(int pos);
+
         bool initialize();
         void finalize();
         void step();
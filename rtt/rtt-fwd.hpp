@@ -56,6 +56,7 @@ namespace RTT
     class CleanupHandle;
     class ConnPolicy;
     class ExecutionEngine;
+    struct ExecutionStatistics;
     class Handle;
     class Logger;
     class PropertyBag;
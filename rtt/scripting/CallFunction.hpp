@@ -189,8 +189,14 @@ namespace RTT
                 // 1. Enqueue as a message callback (for the callback step)
                 //    ==> mrunner will call executeAndDispose() (see below)
                 //
-                maccept = mrunner->process( this );
-                if ( !maccept ) return false;
+                //    maccept must be set before enqueueing, since mrunner may
+                //    already reset it in executeAndDispose() before process() returns.
+                //
+                maccept = true;
+                if ( !mrunner->process( this ) ) {
+                    maccept = false;
+                    return false;
+                }
 
                 // block for the result: foo stopped or in error or yielded
                 mrunner->waitForMessages(boost::bind(&CallFunction::checkIfDoneOrYielded, this) );
@@ -65,6 +65,10 @@ namespace RTT
       {
       }
     ~ConditionBoolDataSource();
+      /**
+       * Returns the internal::DataSource evaluated by this condition.
+       */
+    internal::DataSource<bool>* getDataSource() const { return data.get(); }
     bool evaluate();
     ConditionBoolDataSource* clone() const;
     void reset();
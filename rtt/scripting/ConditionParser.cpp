@@ -47,6 +47,7 @@
 #include "ConditionFalse.hpp"
 #include "ConditionBoolDataSource.hpp"
 #include "ConditionComposite.hpp"
+#include "ExpressionCompiler.hpp"
 
 #include <boost/bind.hpp>
 
@@ -97,6 +98,8 @@ namespace RTT
         if ( ds_bool )
             {
                 mcurdata = 0;
+                // guards are evaluated often: lower the tree if we can.
+                ds_bool = static_cast<DataSource<bool>*>( ExpressionCompiler::compile( ds_bool ).get() );
             }
         else
             {
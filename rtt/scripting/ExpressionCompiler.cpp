@@ -0,0 +1,369 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "ExpressionCompiler.hpp"
+#include "../internal/DataSources.hpp"
+#include "../internal/mystd.hpp"
+#include <functional>
+#include <vector>
+#include <typeinfo>
+
+namespace RTT
+{ namespace scripting {
+    using namespace base;
+    using namespace internal;
+
+    namespace {
+        bool compiler_enabled = true;
+
+        /**
+         * One register of a compiled expression.
+         */
+        union Register
+        {
+            bool b;
+            int i;
+            unsigned int ui;
+            long long ll;
+            unsigned long long ull;
+            float f;
+            double d;
+        };
+
+        /**
+         * Maps a value type on its member in a Register.
+         */
+        template<class T>
+        struct Slot;
+        template<>
+        struct Slot<bool> { static bool& at( Register& r ) { return r.b; } };
+        template<>
+        struct Slot<int> { static int& at( Register& r ) { return r.i; } };
+        template<>
+        struct Slot<unsigned int> { static unsigned int& at( Register& r ) { return r.ui; } };
+        template<>
+        struct Slot<long long> { static long long& at( Register& r ) { return r.ll; } };
+        template<>
+        struct Slot<unsigned long long> { static unsigned long long& at( Register& r ) { return r.ull; } };
+        template<>
+        struct Slot<float> { static float& at( Register& r ) { return r.f; } };
+        template<>
+        struct Slot<double> { static double& at( Register& r ) { return r.d; } };
+
+        struct Instruction;
+        typedef void (*Exec)( Register* regs, const Instruction& ins );
+
+        /**
+         * Writes register \a dst from registers \a a and \a b, or from \a src
+         * for the load instructions.
+         */
+        struct Instruction
+        {
+            Exec exec;
+            unsigned int dst;
+            unsigned int a;
+            unsigned int b;
+            const void* src;
+        };
+
+        template<class F>
+        void execBinary( Register* r, const Instruction& ins )
+        {
+            typedef typename remove_cr<typename F::first_argument_type>::type A;
+            typedef typename remove_cr<typename F::second_argument_type>::type B;
+            typedef typename remove_cr<typename F::result_type>::type R;
+            Slot<R>::at( r[ins.dst] ) = F()( Slot<A>::at( r[ins.a] ), Slot<B>::at( r[ins.b] ) );
+        }
+
+        template<class F>
+        void execUnary( Register* r, const Instruction& ins )
+        {
+            typedef typename remove_cr<typename F::argument_type>::type A;
+            typedef typename remove_cr<typename F::result_type>::type R;
+            Slot<R>::at( r[ins.dst] ) = F()( Slot<A>::at( r[ins.a] ) );
+        }
+
+        /** Loads the result of a DataSource which was not lowered. */
+        template<class T>
+        void execGet( Register* r, const Instruction& ins )
+        {
+            Slot<T>::at( r[ins.dst] ) = static_cast<const DataSource<T>*>( ins.src )->get();
+        }
+
+        /** Loads a variable straight from its storage. */
+        template<class T>
+        void execLoad( Register* r, const Instruction& ins )
+        {
+            Slot<T>::at( r[ins.dst] ) = *static_cast<const T*>( ins.src );
+        }
+
+        struct Program
+        {
+            std::vector<Instruction> code;
+            std::vector<Register> regs;
+
+            void run()
+            {
+                Register* r = &regs[0];
+                for ( const Instruction* i = &code[0], *end = i + code.size(); i != end; ++i )
+                    i->exec( r, *i );
+            }
+
+            void swap( Program& other )
+            {
+                code.swap( other.code );
+                regs.swap( other.regs );
+            }
+        };
+
+        class Lowering
+        {
+            Program& prog;
+        public:
+            explicit Lowering( Program& p ) : prog( p ) {}
+
+            unsigned int allocate()
+            {
+                prog.regs.push_back( Register() );
+                return prog.regs.size() - 1;
+            }
+
+            void emit( Exec exec, unsigned int dst, unsigned int a, unsigned int b, const void* src )
+            {
+                Instruction ins = { exec, dst, a, b, src };
+                prog.code.push_back( ins );
+            }
+
+            /**
+             * Lowers \a ds if it is one of the supported operators.
+             * @return false if \a ds must be evaluated as a leaf.
+             */
+            bool lowerOperator( DataSourceBase* ds, unsigned int& reg );
+
+            /**
+             * Lowers \a ds, falling back to a leaf load.
+             * @return the register holding the value of \a ds.
+             */
+            template<class T>
+            unsigned int lower( DataSource<T>* ds )
+            {
+                unsigned int reg;
+                if ( lowerOperator( ds, reg ) )
+                    return reg;
+                reg = allocate();
+                if ( dynamic_cast<ConstantDataSource<T>*>( ds ) ) {
+                    Slot<T>::at( prog.regs[reg] ) = ds->get();
+                } else if ( typeid( *ds ) == typeid( ValueDataSource<T> )
+                            || typeid( *ds ) == typeid( UnboundDataSource< ValueDataSource<T> > ) ) {
+                    emit( &execLoad<T>, reg, 0, 0, &static_cast<ValueDataSource<T>*>( ds )->set() );
+                } else {
+                    emit( &execGet<T>, reg, 0, 0, ds );
+                }
+                return reg;
+            }
+        };
+
+        typedef bool (*Handler)( Lowering& l, DataSourceBase* ds, unsigned int& reg );
+
+        template<class F>
+        bool lowerBinary( Lowering& l, DataSourceBase* ds, unsigned int& reg )
+        {
+            BinaryDataSource<F>* op = dynamic_cast<BinaryDataSource<F>*>( ds );
+            if ( !op )
+                return false;
+            unsigned int a = l.lower( op->getFirst() );
+            unsigned int b = l.lower( op->getSecond() );
+            reg = l.allocate();
+            l.emit( &execBinary<F>, reg, a, b, 0 );
+            return true;
+        }
+
+        template<class F>
+        bool lowerUnary( Lowering& l, DataSourceBase* ds, unsigned int& reg )
+        {
+            UnaryDataSource<F>* op = dynamic_cast<UnaryDataSource<F>*>( ds );
+            if ( !op )
+                return false;
+            unsigned int a = l.lower( op->getArgument() );
+            reg = l.allocate();
+            l.emit( &execUnary<F>, reg, a, 0, 0 );
+            return true;
+        }
+
+#define ORO_COMPARISONS( T ) \
+        &lowerBinary< std::less< T > >, &lowerBinary< std::less_equal< T > >, \
+        &lowerBinary< std::greater< T > >, &lowerBinary< std::greater_equal< T > >, \
+        &lowerBinary< std::equal_to< T > >, &lowerBinary< std::not_equal_to< T > >
+#define ORO_ARITHMETIC( T ) \
+        &lowerBinary< std::plus< T > >, &lowerBinary< std::minus< T > >, \
+        &lowerBinary< std::multiplies< T > >, &lowerUnary< internal::identity< T > >
+#define ORO_INTEGRAL( T ) \
+        ORO_COMPARISONS( T ), ORO_ARITHMETIC( T ), \
+        &lowerBinary< divides3< T, T, T > >, &lowerBinary< std::modulus< T > >
+
+        /**
+         * The operators registered by the RealTime typekit which can be lowered.
+         */
+        const Handler handlers[] = {
+            &lowerBinary< std::logical_and<bool> >, &lowerBinary< std::logical_or<bool> >,
+            &lowerUnary< std::logical_not<bool> >,
+            &lowerBinary< std::equal_to<bool> >, &lowerBinary< std::not_equal_to<bool> >,
+            ORO_COMPARISONS( double ), ORO_ARITHMETIC( double ),
+            &lowerBinary< std::divides<double> >, &lowerUnary< std::negate<double> >,
+            ORO_INTEGRAL( int ), &lowerUnary< std::negate<int> >,
+            ORO_INTEGRAL( unsigned int ),
+            ORO_INTEGRAL( long long ), &lowerUnary< std::negate<long long> >,
+            ORO_INTEGRAL( unsigned long long ),
+            ORO_COMPARISONS( float ), ORO_ARITHMETIC( float ),
+            &lowerBinary< std::divides<float> >, &lowerUnary< std::negate<float> >
+        };
+
+#undef ORO_INTEGRAL
+#undef ORO_ARITHMETIC
+#undef ORO_COMPARISONS
+
+        bool Lowering::lowerOperator( DataSourceBase* ds, unsigned int& reg )
+        {
+            for ( unsigned int i = 0; i != sizeof( handlers ) / sizeof( handlers[0] ); ++i )
+                if ( handlers[i]( *this, ds, reg ) )
+                    return true;
+            return false;
+        }
+
+        DataSourceBase* compileTree( DataSourceBase* tree );
+
+        /**
+         * Evaluates a lowered expression. The original tree is kept
+         * for reset(), clone() and copy().
+         */
+        template<class T>
+        class CompiledDataSource
+            : public DataSource<T>
+        {
+            DataSourceBase::shared_ptr mtree;
+            mutable Program mprog;
+            unsigned int mresult;
+            mutable T mdata;
+
+            static DataSource<T>* recompile( DataSourceBase* tree )
+            {
+                DataSourceBase* c = compileTree( tree );
+                return static_cast<DataSource<T>*>( c ? c : tree );
+            }
+        public:
+            CompiledDataSource( DataSourceBase* tree, Program& prog, unsigned int result )
+                : mtree( tree ), mresult( result ), mdata()
+            {
+                mprog.swap( prog );
+            }
+
+            T get() const
+            {
+                mprog.run();
+                return mdata = Slot<T>::at( mprog.regs[mresult] );
+            }
+
+            T value() const
+            {
+                return mdata;
+            }
+
+            typename DataSource<T>::const_reference_t rvalue() const
+            {
+                return mdata;
+            }
+
+            void reset()
+            {
+                mtree->reset();
+            }
+
+            DataSource<T>* clone() const
+            {
+                return recompile( mtree->clone() );
+            }
+
+            DataSource<T>* copy( std::map<const DataSourceBase*, DataSourceBase*>& alreadyCloned ) const
+            {
+                return recompile( mtree->copy( alreadyCloned ) );
+            }
+        };
+
+        template<class T>
+        DataSourceBase* compileAs( DataSourceBase* tree )
+        {
+            Program prog;
+            Lowering lowering( prog );
+            unsigned int result;
+            if ( !lowering.lowerOperator( tree, result ) )
+                return 0;
+            return new CompiledDataSource<T>( tree, prog, result );
+        }
+
+        DataSourceBase* compileTree( DataSourceBase* tree )
+        {
+            if ( dynamic_cast<DataSource<bool>*>( tree ) )
+                return compileAs<bool>( tree );
+            if ( dynamic_cast<DataSource<double>*>( tree ) )
+                return compileAs<double>( tree );
+            if ( dynamic_cast<DataSource<int>*>( tree ) )
+                return compileAs<int>( tree );
+            if ( dynamic_cast<DataSource<unsigned int>*>( tree ) )
+                return compileAs<unsigned int>( tree );
+            if ( dynamic_cast<DataSource<long long>*>( tree ) )
+                return compileAs<long long>( tree );
+            if ( dynamic_cast<DataSource<unsigned long long>*>( tree ) )
+                return compileAs<unsigned long long>( tree );
+            if ( dynamic_cast<DataSource<float>*>( tree ) )
+                return compileAs<float>( tree );
+            return 0;
+        }
+    }
+
+    DataSourceBase::shared_ptr ExpressionCompiler::compile( DataSourceBase::shared_ptr expr )
+    {
+        if ( !compiler_enabled || !expr )
+            return expr;
+        DataSourceBase* compiled = compileTree( expr.get() );
+        return compiled ? DataSourceBase::shared_ptr( compiled ) : expr;
+    }
+
+    void ExpressionCompiler::setEnabled( bool enable )
+    {
+        compiler_enabled = enable;
+    }
+
+    bool ExpressionCompiler::isEnabled()
+    {
+        return compiler_enabled;
+    }
+}}
@@ -0,0 +1,84 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_EXPRESSION_COMPILER_HPP
+#define ORO_EXPRESSION_COMPILER_HPP
+
+#include "rtt-scripting-config.h"
+#include "../base/DataSourceBase.hpp"
+
+namespace RTT
+{ namespace scripting {
+
+    /**
+     * Lowers a parsed expression tree into a flat instruction sequence.
+     *
+     * The ExpressionParser builds expressions as a tree of
+     * BinaryDataSource and UnaryDataSource nodes, which costs a virtual
+     * call and a copy of the intermediate result per node on every
+     * evaluation. For the built-in arithmetic, comparison and logical
+     * operators on bool, int, uint, llong, ullong, float and double,
+     * this class replaces such a tree by a DataSource which evaluates
+     * the operators from a linear array of instructions on a register
+     * file. Constants are folded into the registers and variables are
+     * read directly from their storage. Any other node (a conversion,
+     * an operation call, a property,...) is evaluated as before and
+     * its result is loaded as an operand.
+     *
+     * The returned DataSource keeps the original tree, such that
+     * reset(), clone() and copy() behave exactly as on the tree.
+     */
+    class RTT_SCRIPTING_API ExpressionCompiler
+    {
+    public:
+        /**
+         * Compile the expression \a expr.
+         * @return a DataSource of the same type as \a expr, or \a expr itself
+         * if compilation is disabled or the top level node of \a expr is not
+         * one of the supported operators.
+         */
+        static base::DataSourceBase::shared_ptr compile( base::DataSourceBase::shared_ptr expr );
+
+        /**
+         * Enable or disable compilation of newly parsed expressions.
+         * Compilation is enabled by default.
+         */
+        static void setEnabled( bool enable );
+
+        /**
+         * Returns true if compile() lowers expressions.
+         */
+        static bool isEnabled();
+    };
+}}
+
+#endif
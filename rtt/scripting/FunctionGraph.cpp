@@ -64,6 +64,9 @@ namespace RTT {
         put(vertex_exec, program, startv, VertexNode::normal_node );
         exitv = add_vertex( program );
         put(vertex_exec, program, exitv, VertexNode::normal_node);
+        this->flatten();
+        current = mstart;
+        previous = mexit;
     }
 
     FunctionGraph::FunctionGraph( const FunctionGraph& orig )
@@ -95,12 +98,21 @@ namespace RTT {
     {
         put(vertex_exec, program, startv, VertexNode::func_start_node );
         put(vertex_exec, program, exitv, VertexNode::func_exit_node);
+        this->flatten();
+        this->reset();
+    }
 
+    void FunctionGraph::flatten()
+    {
         // Because we use listS, we need to re-index the map :-(
         // If we do not do this, it can not be copied by the copy_graph
         // function.
         property_map<Graph, vertex_index_t>::type
             index = get(vertex_index, program);
+        property_map<Graph, vertex_command_t>::type
+            cmap = get(vertex_command, program);
+        property_map<Graph, edge_condition_t>::type
+            emap = get(edge_condition, program);
 
         // initialize the vertex_index property values
         // so that it can be copied into other graphs.
@@ -108,7 +120,28 @@ namespace RTT {
         graph_traits<Graph>::vertices_size_type cnt = 0;
         for(tie(vi,vend) = vertices(program); vi != vend; ++vi)
             put(index, *vi, cnt++);
-        this->reset();
+
+        // lay out the nodes by index and their out edges behind
+        // each other, in the order in which they are evaluated.
+        graph_traits<Graph>::out_edge_iterator ei, ei_end;
+        msteps.resize( cnt );
+        mvertices.resize( cnt );
+        mbranches.clear();
+        for(tie(vi,vend) = vertices(program); vi != vend; ++vi) {
+            Step& step = msteps[ index[*vi] ];
+            step.node = &cmap[*vi];
+            step.first = mbranches.size();
+            for ( tie(ei, ei_end) = boost::out_edges( *vi, program ); ei != ei_end; ++ei) {
+                Branch branch;
+                branch.condition = emap[*ei].getCondition();
+                branch.target = index[ boost::target(*ei, program) ];
+                mbranches.push_back( branch );
+            }
+            step.last = mbranches.size();
+            mvertices[ index[*vi] ] = *vi;
+        }
+        mstart = index[startv];
+        mexit = index[exitv];
     }
 
     FunctionGraph::~FunctionGraph()
@@ -227,24 +260,18 @@ namespace RTT {
 
     bool FunctionGraph::executeUntil()
     {
-        graph_traits<Graph>::out_edge_iterator ei, ei_end;
-        // the map contains _references_ to all vertex_command properties
-        boost::property_map<Graph, vertex_command_t>::type
-            cmap = get(vertex_command, program);
-        boost::property_map<Graph, edge_condition_t>::type
-            emap = get(edge_condition, program);
-
         do {
+            Step& step = msteps[current];
             // Check this always on entry of executeUntil :
             // initialise current node if needed and reset all its out_edges
             // if previous == current, we DO NOT RESET, because we want to check
             // if previous command has completed !
             if ( previous != current )
                 {
-                    for ( tie(ei, ei_end) = boost::out_edges( current, program ); ei != ei_end; ++ei)
-                        emap[*ei].reset();
+                    for ( unsigned int b = step.first; b != step.last; ++b)
+                        mbranches[b].condition->reset();
                     try {
-                        cmap[current].startExecution();
+                        step.node->startExecution();
                     } catch(...) {
                         pStatus = Status::error;
                         return false;
@@ -255,18 +282,18 @@ namespace RTT {
             previous = current;
             // execute the current command.
             try {
-                cmap[current].execute();
+                step.node->execute();
             } catch(...) {
                 pStatus = Status::error;
                 return false;
             }
 
             // Branch selecting Logic :
-            if ( cmap[current].isValid() ) {
-                for ( tie(ei, ei_end) = boost::out_edges( current, program ); ei != ei_end; ++ei) {
+            if ( step.node->isValid() ) {
+                for ( unsigned int b = step.first; b != step.last; ++b) {
                     try {
-                        if ( emap[*ei].evaluate() ) {
-                            current = boost::target(*ei, program);
+                        if ( mbranches[b].condition->evaluate() ) {
+                            current = mbranches[b].target;
                             // a new node has been found ...
                             // so continue
                             break; // exit from for loop.
@@ -280,7 +307,7 @@ namespace RTT {
         } while ( previous != current && pStatus == Status::running && !pausing); // keep going if we found a new node
 
         // check finished state
-        if (current == exitv) {
+        if (current == mexit) {
             this->stop();
             return !munload_on_stop;
         }
@@ -289,20 +316,15 @@ namespace RTT {
 
     bool FunctionGraph::executeStep()
     {
-        graph_traits<Graph>::out_edge_iterator ei, ei_end;
-        // the map contains _references_ to all vertex_command properties
-        boost::property_map<Graph, vertex_command_t>::type
-            cmap = get(vertex_command, program);
-        boost::property_map<Graph, edge_condition_t>::type
-            emap = get(edge_condition, program);
+        Step& step = msteps[current];
 
         // initialise current node if needed and reset all its out_edges
         if ( previous != current )
         {
-            for ( tie(ei, ei_end) = boost::out_edges( current, program ); ei != ei_end; ++ei)
-                emap[*ei].reset();
+            for ( unsigned int b = step.first; b != step.last; ++b)
+                mbranches[b].condition->reset();
             try {
-                cmap[current].startExecution();
+                step.node->startExecution();
             } catch(...) {
                 pStatus = Status::error;
                 return false;
@@ -312,19 +334,19 @@ namespace RTT {
 
         // execute the current command.
         try {
-            cmap[current].execute();
+            step.node->execute();
         } catch(...) {
             pStatus = Status::error;
             return false;
         }
 
         // Branch selecting Logic :
-        if ( cmap[current].isValid() ) {
-            for ( tie(ei, ei_end) = boost::out_edges( current, program ); ei != ei_end; ++ei) {
+        if ( step.node->isValid() ) {
+            for ( unsigned int b = step.first; b != step.last; ++b) {
                 try {
-                    if ( emap[*ei].evaluate() ) {
-                        current = boost::target(*ei, program);
-                        if (current == exitv)
+                    if ( mbranches[b].condition->evaluate() ) {
+                        current = mbranches[b].target;
+                        if (current == mexit)
                             this->stop();
                         // a new node has been found ...
                         // it will be executed in the next step.
@@ -337,14 +359,14 @@ namespace RTT {
             }
         }
         // check finished state
-        if (current == exitv)
+        if (current == mexit)
             this->stop();
         return true; // no new branch found yet !
     }
 
     void FunctionGraph::reset() {
-        current = startv;
-        previous = exitv;
+        current = mstart;
+        previous = mexit;
         this->stop();
     }
 
@@ -377,7 +399,7 @@ namespace RTT {
 
     int FunctionGraph::getLineNumber() const
     {
-        return get(vertex_command, program)[current].getLineNumber();
+        return msteps[current].node->getLineNumber();
     }
 
     FunctionGraph* FunctionGraph::copy( std::map<const DataSourceBase*, DataSourceBase*>& replacementdss ) const
@@ -417,8 +439,6 @@ namespace RTT {
 
         ret->startv = o2cmap[startv];
         ret->exitv = o2cmap[exitv];
-        ret->current = o2cmap[current];
-        ret->previous = o2cmap[previous];
 
         // so that ret itself can be copied again :
         ret->finish();
@@ -73,14 +73,54 @@ namespace RTT
 
     private:
         /**
-         * The node which is executed now
+         * A node of the flattened program: its command and the
+         * range [first, last) of its out edges in mbranches.
          */
-        Vertex current;
+        struct Step
+        {
+            VertexNode* node;
+            unsigned int first;
+            unsigned int last;
+        };
+
+        /**
+         * An out edge of a Step: its condition and the index
+         * of the Step it leads to.
+         */
+        struct Branch
+        {
+            ConditionInterface* condition;
+            unsigned int target;
+        };
+
+        /**
+         * The program graph, flattened by finish() and indexed by
+         * vertex_index. Execution only walks these arrays.
+         */
+        std::vector<Step> msteps;
+        std::vector<Branch> mbranches;
+        std::vector<Vertex> mvertices;
+
+        /**
+         * The index of the node which is executed now
+         */
+        unsigned int current;
+
+        /**
+         * The index of the node that was run before this one.
+         */
+        unsigned int previous;
+
+        /**
+         * The indexes of startv and exitv.
+         */
+        unsigned int mstart, mexit;
 
         /**
-         * The node that was run before this one.
+         * Re-indexes the vertices of program and rebuilds
+         * msteps, mbranches and mvertices from it.
          */
-        Vertex previous;
+        void flatten();
 
     protected:
         /**
@@ -157,6 +197,8 @@ namespace RTT
 
         /**
          * To be called after a function is constructed.
+         * This flattens the graph for execution, so the graph
+         * may no longer be modified afterwards.
          */
         void finish();
 
@@ -211,12 +253,12 @@ namespace RTT
 
         Vertex currentNode() const
         {
-            return current;
+            return mvertices[current];
         }
 
         Vertex previousNode() const
         {
-            return previous;
+            return mvertices[previous];
         }
 
         Vertex exitNode() const
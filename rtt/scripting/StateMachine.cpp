@@ -39,6 +39,10 @@
 #include "../internal/DataSource.hpp"
 #include "../Service.hpp"
 #include "CommandFunctors.hpp"
+#include "ConditionTrue.hpp"
+#include "ConditionFalse.hpp"
+#include "ConditionBoolDataSource.hpp"
+#include "../internal/DataSources.hpp"
 #include <Logger.hpp>
 #include <functional>
 
@@ -67,6 +71,7 @@ namespace RTT {
         : smpStatus(nill), _parent (parent) , _name(name), smStatus(Status::unloaded),
           initstate(0), finistate(0), current( 0 ), next(0), initc(0),
           currentProg(0), currentExit(0), currentHandle(0), currentEntry(0), currentRun(0), currentTrans(0),
+          mglobal(0), mcurtable(0), mnexttable(0), mtables_dirty(true), mprec(0), mprec_pos(0),
           checking_precond(false), mstep(false), mtrace(false), evaluating(0)
     {
         this->addState(0); // allows global state transitions
@@ -84,6 +89,7 @@ namespace RTT {
    void StateMachine::loading() {
        TRACE( "Being Loaded in ExecutionEngine." );
        smStatus = Status::inactive;
+       this->buildTables();
        for(TransitionMap::iterator it=stateMap.begin(); it != stateMap.end(); ++it) {
            // inform all entry/exit state scripts:
            if (it->first)
@@ -407,6 +413,11 @@ namespace RTT {
     }
 
     void StateMachine::changeState(StateInterface* newState, ProgramInterface* transProg, bool stepping) {
+        this->changeState( tableOf( newState ), transProg, stepping );
+    }
+
+    void StateMachine::changeState(StateTable* target, ProgramInterface* transProg, bool stepping) {
+        StateInterface* newState = target->state;
         if ( newState == current )
             {
                 // this is only true if current state was selected in a transition of current.
@@ -417,7 +428,7 @@ namespace RTT {
                         smStatus = Status::error;
                     currentTrans = transProg;
                     // manually reset reqstep, or the next iteration would skip transition checks.
-                    reqstep = stateMap.find( current )->second.begin();
+                    reqstep = mcurtable->transitions->begin();
                     // from now on, we are in transition to self !
                     // currentRun is _not_ set to zero or reset.
                     // it is/may be interrupted by trans, then continued.
@@ -447,6 +458,7 @@ namespace RTT {
                 currentTrans = transProg;
 
                 next = newState;
+                mnexttable = target;
 
                 disableEvents(current);
                 leaveState(current);
@@ -473,7 +485,10 @@ namespace RTT {
 //            TRACE("Enabling events for state '"+s->getName()+"'.");
 //        } else
 //            TRACE("Enabling global events.");
-        EventMap::mapped_type& hlist = eventMap[s];
+        StateTable* t = tableOf( s );
+        if ( t == 0 || t->events == 0 )
+            return;
+        EventList& hlist = *t->events;
         for (EventList::iterator eit = hlist.begin();
              eit != hlist.end();
              ++eit) {
@@ -487,7 +502,10 @@ namespace RTT {
 //            TRACE("Disabling events for state '"+s->getName()+"'.");
 //        } else
 //            TRACE("Disabling global events.");
-        EventMap::mapped_type& hlist = eventMap[s];
+        StateTable* t = tableOf( s );
+        if ( t == 0 || t->events == 0 )
+            return;
+        EventList& hlist = *t->events;
                 for (EventList::iterator eit = hlist.begin();
                      eit != hlist.end();
                      ++eit) {
@@ -555,6 +573,7 @@ namespace RTT {
         // add the states to the statemap.
         stateMap[from];
         stateMap[to];
+        mtables_dirty = true;
         return true;
     }
 
@@ -625,66 +644,67 @@ namespace RTT {
         }
 
         // Reset global conditions.
-        TransList::const_iterator it, it1, it2;
-        it1 = stateMap.find( 0 )->second.begin();
-        it2 = stateMap.find( 0 )->second.end();
+        TransList& globals = *mglobal->transitions;
+        TransList::iterator it;
 
-        if ( reqstep == stateMap.find( current )->second.begin() ) // avoid reseting too much in stepping mode.
-            for ( it= it1; it != it2; ++it)
+        if ( reqstep == mcurtable->transitions->begin() ) // avoid reseting too much in stepping mode.
+            for ( it= globals.begin(); it != globals.end(); ++it)
                 get<0>(*it)->reset();
 
         if ( reqstep == reqend ) { // if nothing to evaluate, eval globals, then just handle()
 
-            for ( ; it1 != it2; ++it1 )
-                if ( get<0>(*it1)->evaluate()
-                     && checkConditions( get<1>(*it1) ) == 1 ) {
-                    StateInterface* next = get<1>(*it1);
-                    if ( next == 0 ) // handle current if no next
-                        changeState( current, get<4>(*it1).get(), stepping );
+            for ( unsigned int g = 0; g != globals.size(); ++g )
+                if ( evaluateGuard( mglobal, g )
+                     && checkConditions( mglobal->targets[g], false ) == 1 ) {
+                    StateTable* next = mglobal->targets[g];
+                    if ( next->state == 0 ) // handle current if no next
+                        changeState( mcurtable, get<4>(globals[g]).get(), stepping );
                     else
-                        changeState( next, get<4>(*it1).get(), stepping );
+                        changeState( next, get<4>(globals[g]).get(), stepping );
                     // the request was accepted
                     return current;
                 }
             // no transition found: handle()
-            changeState( current, 0, stepping );
+            changeState( mcurtable, 0, stepping );
             return current;
         }
 
         // if we got here, at least one evaluation to check
         do {
-            if ( get<0>(*reqstep)->evaluate() ) {
+            StateTable* table = mcurtable;
+            if ( evaluateGuard( table, reqstep - table->transitions->begin() ) ) {
                 // evaluate() might call stop() or other sm functions:
-                if (reqstep == reqend )
+                if (reqstep == reqend || table != mcurtable )
                     return current;
                 // check preconds of target state :
-                int cres = checkConditions( get<1>(*reqstep), stepping );
+                StateTable* target = table->targets[ reqstep - table->transitions->begin() ];
+                int cres = checkConditions( target, stepping );
                 if (cres == 0) {
                     break; // only returned in stepping
                 }
                 if( cres == 1) {
-                    changeState( get<1>(*reqstep), get<4>(*reqstep).get(), stepping );
+                    changeState( target, get<4>(*reqstep).get(), stepping );
                     break; // valid transition
                 }
                 // if cres == -1 : precondition failed, increment reqstep...
             }
              if ( reqstep + 1 == reqend ) {
                 // to a state specified by the user (global)
-                for ( ; it1 != it2; ++it1 ) {
-                    if ( get<0>(*it1)->evaluate() && checkConditions( get<1>(*it1) ) == 1 ) {
-                             StateInterface* next = get<1>(*it1);
-                             if ( next == 0) // handle current if no next
-                                 changeState( current, get<4>(*it1).get(), stepping );
+                for ( unsigned int g = 0; g != globals.size(); ++g ) {
+                    if ( evaluateGuard( mglobal, g ) && checkConditions( mglobal->targets[g], false ) == 1 ) {
+                             StateTable* next = mglobal->targets[g];
+                             if ( next->state == 0) // handle current if no next
+                                 changeState( mcurtable, get<4>(globals[g]).get(), stepping );
                              else
-                                 changeState( next, get<4>(*it1).get(), stepping );
+                                 changeState( next, get<4>(globals[g]).get(), stepping );
                              // the request was accepted
                              return current;
                          }
                     }
                 // no transition was found, reset and 'schedule' a handle :
-                reqstep = stateMap.find( current )->second.begin();
+                reqstep = mcurtable->transitions->begin();
                 evaluating = get<3>(*reqstep);
-                changeState( current, 0, stepping );
+                changeState( mcurtable, 0, stepping );
                 break;
             }
             else {
@@ -697,29 +717,34 @@ namespace RTT {
     }
 
     int StateMachine::checkConditions( StateInterface* state, bool stepping ) {
+        return this->checkConditions( tableOf( state ), stepping );
+    }
+
+    int StateMachine::checkConditions( StateTable* target, bool stepping ) {
 
-        // if the preconditions of \a state are checked the first time in stepping mode, reset the iterators.
+        // if the preconditions of \a target are checked the first time in stepping mode, reset the position.
         if ( !checking_precond || !stepping ) {
-            prec_it = precondMap.equal_range(state); // state is the _target_ state
+            mprec = &target->preconditions; // target is the _target_ state
+            mprec_pos = 0;
         }
 
         // will be set to true if stepping below.
         //checking_precond = false;
 
-        while ( prec_it.first != prec_it.second ) {
+        while ( mprec_pos != mprec->size() ) {
             if (checking_precond == false && stepping ) {
-                evaluating = prec_it.first->second.second; // indicate we will evaluate this line (if any).
+                evaluating = (*mprec)[mprec_pos].second; // indicate we will evaluate this line (if any).
                 checking_precond = true;
                 return 0;
             }
-            if ( prec_it.first->second.first->evaluate() == false ) {
+            if ( (*mprec)[mprec_pos].first->evaluate() == false ) {
                 checking_precond = false;
                 return -1; // precondition failed
             }
-            ++( prec_it.first );
+            ++mprec_pos;
             if (stepping) {
-                if ( prec_it.first != prec_it.second )
-                    evaluating = prec_it.first->second.second; // indicate we will evaluate the next line (if any).
+                if ( mprec_pos != mprec->size() )
+                    evaluating = (*mprec)[mprec_pos].second; // indicate we will evaluate the next line (if any).
                 checking_precond = true;
                 return 0; // not done yet.
             }
@@ -728,6 +753,76 @@ namespace RTT {
         return 1; // success !
     }
 
+    bool StateMachine::evaluateGuard( StateTable* t, unsigned int i )
+    {
+        int cached = t->guards[i];
+        if ( cached < 0 )
+            return get<0>( (*t->transitions)[i] )->evaluate();
+        return cached != 0;
+    }
+
+    namespace {
+        /**
+         * Returns 1 or 0 if \a c always evaluates to true or false,
+         * -1 if \a c must be evaluated.
+         */
+        int constantGuard( ConditionInterface* c )
+        {
+            if ( dynamic_cast<ConditionTrue*>( c ) )
+                return 1;
+            if ( dynamic_cast<ConditionFalse*>( c ) )
+                return 0;
+            ConditionBoolDataSource* cbd = dynamic_cast<ConditionBoolDataSource*>( c );
+            if ( cbd && dynamic_cast<ConstantDataSource<bool>*>( cbd->getDataSource() ) )
+                return cbd->getDataSource()->get() ? 1 : 0;
+            return -1;
+        }
+    }
+
+    void StateMachine::buildTables()
+    {
+        mtables.clear();
+        mtable_index.clear();
+        mtables.resize( stateMap.size() );
+        unsigned int i = 0;
+        for ( TransitionMap::iterator it = stateMap.begin(); it != stateMap.end(); ++it, ++i ) {
+            mtables[i].state = it->first;
+            mtables[i].transitions = &it->second;
+            EventMap::iterator eit = eventMap.find( it->first );
+            mtables[i].events = eit == eventMap.end() ? 0 : &eit->second;
+            mtable_index[ it->first ] = &mtables[i];
+        }
+        for ( vector<StateTable>::iterator t = mtables.begin(); t != mtables.end(); ++t ) {
+            for ( TransList::iterator tr = t->transitions->begin(); tr != t->transitions->end(); ++tr ) {
+                t->targets.push_back( mtable_index[ get<1>(*tr) ] );
+                t->guards.push_back( constantGuard( get<0>(*tr) ) );
+            }
+            pair<PreConditionMap::const_iterator,PreConditionMap::const_iterator> prec = precondMap.equal_range( t->state );
+            for ( ; prec.first != prec.second; ++prec.first )
+                t->preconditions.push_back( prec.first->second );
+        }
+        mglobal = mtable_index[0];
+        mcurtable = current ? mtable_index[current] : 0;
+        mnexttable = next ? mtable_index[next] : 0;
+        mprec = 0;
+        checking_precond = false;
+        mtables_dirty = false;
+    }
+
+    StateMachine::StateTable* StateMachine::tableOf( StateInterface* s )
+    {
+        if ( mtables_dirty )
+            this->buildTables();
+        // the states at hand don't need a lookup.
+        if ( s == 0 )
+            return mglobal;
+        if ( mcurtable && mcurtable->state == s )
+            return mcurtable;
+        if ( mnexttable && mnexttable->state == s )
+            return mnexttable;
+        std::map<StateInterface*, StateTable*>::iterator it = mtable_index.find( s );
+        return it == mtable_index.end() ? 0 : it->second;
+    }
 
     StateInterface* StateMachine::nextState()
     {
@@ -735,22 +830,15 @@ namespace RTT {
         // bad idea, user, don't run this if we're not active...
         if ( current == 0 )
             return 0;
-        TransList::const_iterator it1, it2;
-        it1 = stateMap.find( current )->second.begin();
-        it2 = stateMap.find( current )->second.end();
-
-        for ( ; it1 != it2; ++it1 )
-            if ( get<0>(*it1)->evaluate() && checkConditions( get<1>(*it1)) == 1 ) {
-                return get<1>(*it1);
+        for ( unsigned int i = 0; i != mcurtable->transitions->size(); ++i )
+            if ( evaluateGuard( mcurtable, i ) && checkConditions( mcurtable->targets[i], false ) == 1 ) {
+                return mcurtable->targets[i]->state;
             }
 
         // also check the global transitions.
-        it1 = stateMap.find( 0 )->second.begin();
-        it2 = stateMap.find( 0 )->second.end();
-
-        for ( ; it1 != it2; ++it1 )
-            if ( get<0>(*it1)->evaluate() && checkConditions( get<1>(*it1)) == 1 ) {
-                return get<1>(*it1);
+        for ( unsigned int g = 0; g != mglobal->transitions->size(); ++g )
+            if ( evaluateGuard( mglobal, g ) && checkConditions( mglobal->targets[g], false ) == 1 ) {
+                return mglobal->targets[g]->state;
             }
 
         return current;
@@ -769,6 +857,7 @@ namespace RTT {
     void StateMachine::addState( StateInterface* s )
     {
         stateMap[s];
+        mtables_dirty = true;
     }
 
 
@@ -805,34 +894,30 @@ namespace RTT {
         }
 
         // between 2 states specified by the user.
-        TransList::iterator it, it1, it2;
-        it1 = stateMap.find( current )->second.begin();
-        it2 = stateMap.find( current )->second.end();
-
-        for ( ; it1 != it2; ++it1 )
-            if ( get<1>(*it1) == s_n
-                 && get<0>(*it1)->evaluate()
-                 && checkConditions( s_n ) == 1 ) {
-                changeState( s_n, get<4>(*it1).get() );
+        TransList& trans = *mcurtable->transitions;
+        for ( unsigned int i = 0; i != trans.size(); ++i )
+            if ( get<1>(trans[i]) == s_n
+                 && evaluateGuard( mcurtable, i )
+                 && checkConditions( mcurtable->targets[i], false ) == 1 ) {
+                changeState( mcurtable->targets[i], get<4>(trans[i]).get(), false );
                 // the request was accepted
                 executePending();
                 return true;
             }
 
         // to a state specified by the user (global)
-        it1 = stateMap.find( 0 )->second.begin();
-        it2 = stateMap.find( 0 )->second.end();
+        TransList& globals = *mglobal->transitions;
 
         // reset all conditions
-        for ( it= it1; it != it2; ++it)
+        for ( TransList::iterator it = globals.begin(); it != globals.end(); ++it)
             get<0>(*it)->reset();
 
         // evaluate them
-        for ( ; it1 != it2; ++it1 )
-            if ( get<1>(*it1) == s_n
-                 && get<0>(*it1)->evaluate()
-                 && checkConditions( s_n ) == 1 ) {
-                changeState( s_n, get<4>(*it1).get() );
+        for ( unsigned int g = 0; g != globals.size(); ++g )
+            if ( get<1>(globals[g]) == s_n
+                 && evaluateGuard( mglobal, g )
+                 && checkConditions( mglobal->targets[g], false ) == 1 ) {
+                changeState( mglobal->targets[g], get<4>(globals[g]).get(), false );
                 // the request was accepted
                 executePending();
                 return true;
@@ -886,6 +971,7 @@ namespace RTT {
             return;
         precondMap.insert( make_pair(state, make_pair( cnd, line)) );
         stateMap[state]; // add to state map.
+        mtables_dirty = true;
     }
 
     void StateMachine::transitionSet( StateInterface* from, StateInterface* to, ConditionInterface* cnd, int priority, int line )
@@ -912,6 +998,7 @@ namespace RTT {
             ; // this ';' is intentional
         stateMap[from].insert(it, boost::make_tuple( cnd, to, priority, line, transprog ) );
         stateMap[to]; // insert empty vector for 'to' state.
+        mtables_dirty = true;
     }
 
     StateInterface* StateMachine::currentState() const
@@ -964,8 +1051,8 @@ namespace RTT {
 //        TRACE( "Planning to enter state " + s->getName() );
 
         // Before a state is entered, all transitions are reset !
-        TransList::iterator it;
-        for ( it= stateMap.find(s)->second.begin(); it != stateMap.find(s)->second.end(); ++it)
+        TransList& trans = *tableOf( s )->transitions;
+        for ( TransList::iterator it= trans.begin(); it != trans.end(); ++it)
             get<0>(*it)->reset();
 
         currentEntry = s->getEntryProgram();
@@ -1040,8 +1127,8 @@ namespace RTT {
         // if we did not change state, it will be reset in requestNextState().
         if ( current != next ) {
             if ( next ) {
-                reqstep = stateMap.find( next )->second.begin();
-                reqend  = stateMap.find( next )->second.end();
+                reqstep = mnexttable->transitions->begin();
+                reqend  = mnexttable->transitions->end();
                 // init for getLineNumber() :
                 if ( reqstep == reqend )
                     evaluating = 0;
@@ -1049,12 +1136,14 @@ namespace RTT {
                     evaluating = get<3>(*reqstep);
             } else {
                 current = 0;
+                mcurtable = 0;
                 return true;  // done if current == 0 !
             }
             // make change transition after exit of previous state:
             TRACE("Formally  transitioning from      '"+ (current ? current->getName() : "(null)") + "' to '"+ (next ? next->getName() : "(null)") +"'" );
 
             current = next;
+            mcurtable = mnexttable;
             enterState(next);
             enableEvents(next);
         }
@@ -1145,12 +1234,14 @@ namespace RTT {
     {
         initstate = s;
         stateMap[initstate];
+        mtables_dirty = true;
     }
 
     void StateMachine::setFinalState( StateInterface* s )
     {
         finistate = s;
         stateMap[finistate];
+        mtables_dirty = true;
     }
 
     void StateMachine::trace(bool t) {
@@ -1184,9 +1275,10 @@ namespace RTT {
 
         current = getInitialState();
         next = current;
+        mcurtable = mnexttable = tableOf( current );
         enterState( getInitialState() );
-        reqstep = stateMap.find( next )->second.begin();
-        reqend = stateMap.find( next )->second.end();
+        reqstep = mcurtable->transitions->begin();
+        reqend = mcurtable->transitions->end();
 
         // Enable all event handlers
         enableGlobalEvents();
@@ -1243,6 +1335,7 @@ namespace RTT {
         currentHandle  = 0;
         currentRun  = 0;
         next = 0;
+        mnexttable = 0;
 
         // this will execute the exitFunction (if any) and, if successfull,
         // set current to zero (using next).
@@ -638,6 +638,49 @@ namespace RTT
         void enableEvents( StateInterface* s );
         void disableEvents( StateInterface* s );
     private:
+        /**
+         * The transitions, events and preconditions of one state,
+         * laid out by buildTables() such that a step does not need to
+         * search stateMap, eventMap or precondMap.
+         */
+        struct StateTable
+        {
+            StateInterface* state;
+            TransList* transitions;
+            /**
+             * The events of \a state, null if it has none.
+             */
+            EventList* events;
+            /**
+             * The table of the target state of each transition.
+             */
+            std::vector<StateTable*> targets;
+            /**
+             * The cached result of each transition guard: 1 or 0 if
+             * the guard can not change, -1 if it must be evaluated.
+             */
+            std::vector<int> guards;
+            std::vector< std::pair<ConditionInterface*, int> > preconditions;
+        };
+
+        /**
+         * Builds mtables from stateMap, eventMap and precondMap.
+         * Called when the StateMachine is loaded or activated after
+         * a state, transition, event or precondition was added.
+         */
+        void buildTables();
+
+        /**
+         * Returns the table of \a s, or null if \a s is not a state
+         * of this StateMachine.
+         */
+        StateTable* tableOf( StateInterface* s );
+
+        bool evaluateGuard( StateTable* t, unsigned int i );
+
+        int checkConditions( StateTable* target, bool stepping );
+
+        void changeState( StateTable* target, ProgramInterface* tprog, bool stepping );
 
         /**
          * Internal use only. Make a transition to state 'to' with transitionprogram 'p' under condition 'c'.
@@ -680,7 +723,21 @@ namespace RTT
         TransList::iterator reqstep;
         TransList::iterator reqend;
 
-        std::pair<PreConditionMap::const_iterator,PreConditionMap::const_iterator> prec_it;
+        /**
+         * One table per state, mglobal is the one of the global (null) state.
+         */
+        std::vector<StateTable> mtables;
+        std::map<StateInterface*, StateTable*> mtable_index;
+        StateTable* mglobal;
+        StateTable* mcurtable;
+        StateTable* mnexttable;
+        bool mtables_dirty;
+
+        /**
+         * The preconditions being checked by checkConditions().
+         */
+        const std::vector< std::pair<ConditionInterface*, int> >* mprec;
+        unsigned int mprec_pos;
         bool checking_precond;
         bool mstep, mtrace;
 
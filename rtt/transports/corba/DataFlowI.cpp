@@ -600,5 +600,15 @@ PortableServer::POA_ptr CRemoteChannelElement_i::_default_POA()
 void CRemoteChannelElement_i::setRemoteSide(CRemoteChannelElement_ptr remote) ACE_THROW_SPEC ((
 	      CORBA::SystemException
 	    ))
-{ this->remote_side = RTT::corba::CRemoteChannelElement::_duplicate(remote); }
+{
+    this->remote_side = RTT::corba::CRemoteChannelElement::_duplicate(remote);
+    // Peers built with an older DataFlow.idl don't implement the batch
+    // interface, in which case samples are transferred one by one.
+    try {
+        this->remote_batch = RTT::corba::CRemoteBatchChannelElement::_narrow(remote);
+    }
+    catch(CORBA::Exception&) {
+        this->remote_batch = RTT::corba::CRemoteBatchChannelElement::_nil();
+    }
+}
 
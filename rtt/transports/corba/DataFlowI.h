@@ -67,11 +67,16 @@ namespace RTT {
          * which transports data over a CORBA connection.
          */
         class RTT_CORBA_API CRemoteChannelElement_i
-            : public POA_RTT::corba::CRemoteChannelElement
+            : public POA_RTT::corba::CRemoteBatchChannelElement
             , public virtual PortableServer::RefCountServantBase
         {
         protected:
             CRemoteChannelElement_var remote_side;
+            /**
+             * Same object as remote_side, or nil if the remote side
+             * does not implement CRemoteBatchChannelElement.
+             */
+            CRemoteBatchChannelElement_var remote_batch;
             RTT::corba::CorbaTypeTransporter const& transport;
             PortableServer::POA_var mpoa;
             CDataFlowInterface_i* mdataflow;
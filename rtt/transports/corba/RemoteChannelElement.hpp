@@ -43,6 +43,7 @@
 #include "CorbaTypeTransporter.hpp"
 #include "CorbaDispatcher.hpp"
 #include "ApplicationServer.hpp"
+#include <deque>
 
 namespace RTT {
 
@@ -54,6 +55,9 @@ namespace RTT {
 	 * A read will cause a call to the remote channel (which is of the
 	 * same type of this RemoteChannelElement) which returns an Any
 	 * with the data. A similar mechanism is in place for a write.
+	 * If the remote channel implements CRemoteBatchChannelElement, the
+	 * samples are transferred in batches of at most max_batch_samples
+	 * per call instead.
 	 */
 	template<typename T>
 	class RemoteChannelElement 
@@ -75,7 +79,17 @@ namespace RTT {
             PortableServer::ObjectId_var oid;
 
             std::string localUri;
+
+            /**
+             * Samples which were pulled in a batch, but not read yet.
+             */
+            std::deque<T> mpulled;
 	public:
+            /**
+             * The maximum number of samples transferred in one remote call.
+             */
+            static const CORBA::ULong max_batch_samples = 64;
+
 	    /**
 	     * Create a channel element for remote data exchange.
 	     * @param transport The type specific object that will be used to marshal the data.
@@ -154,6 +168,37 @@ namespace RTT {
                         log(Error) << "caught CORBA exception while signalling our remote endpoint: " << e._name() << endlog();
                         valid = false;
                     }
+                } else if ( !CORBA::is_nil(remote_batch.in()) ) {
+                    /** This is used on to read the channel */
+                    typename base::ChannelElement<T>::value_t sample;
+                    internal::LateConstReferenceDataSource<T> const_ref_data_source(&sample);
+                    const_ref_data_source.ref();
+                    CSamples samples;
+
+                    while ( valid ) {
+                        samples.length(0);
+                        while ( samples.length() != max_batch_samples && base::ChannelElement<T>::read(sample, false) == NewData ) {
+                            CORBA::ULong n = samples.length();
+                            samples.length(n + 1);
+                            transport.updateAny(&const_ref_data_source, samples[n]);
+                        }
+                        if ( samples.length() == 0 )
+                            break;
+                        try
+                        { remote_batch->writeSamples(samples); }
+#ifdef CORBA_IS_OMNIORB
+                        catch(CORBA::SystemException& e)
+                        {
+                            log(Error) << "caught CORBA exception while marshalling: " << e._name() << " " << e.NP_minorString() << endlog();
+                            valid = false;
+                        }
+#endif
+                        catch(CORBA::Exception& e)
+                        {
+                            log(Error) << "caught CORBA exception while marshalling: " << e._name() << endlog();
+                            valid = false;
+                        }
+                    }
                 } else {
                     /** This is used on to read the channel */
                     typename base::ChannelElement<T>::value_t sample;
@@ -242,11 +287,35 @@ namespace RTT {
                 if ( (fs = base::ChannelElement<T>::read(sample, copy_old_data)) )
                     return fs;
 
+                // then samples left over from a batched pull.
+                if ( !mpulled.empty() ) {
+                    sample = mpulled.front();
+                    mpulled.pop_front();
+                    return NewData;
+                }
+
                 // go through corba
                 CORBA::Any_var remote_value;
                 try
                 {
-                    if ( remote_side && (cfs = remote_side->read(remote_value, copy_old_data) ) )
+                    if ( !CORBA::is_nil(remote_batch.in()) )
+                    {
+                        CSamples_var remote_values;
+                        cfs = remote_batch->readSamples(remote_values.out(), max_batch_samples, copy_old_data);
+                        if ( remote_values->length() != 0 && (cfs == CNewData || (cfs == COldData && copy_old_data)) ) {
+                            internal::LateReferenceDataSource<T> ref_data_source(&sample);
+                            ref_data_source.ref();
+                            transport.updateFromAny(&remote_values[0], &ref_data_source);
+                            for (CORBA::ULong i = 1; i < remote_values->length(); ++i) {
+                                mpulled.push_back( sample );
+                                internal::LateReferenceDataSource<T> pulled_data_source(&mpulled.back());
+                                pulled_data_source.ref();
+                                transport.updateFromAny(&remote_values[i], &pulled_data_source);
+                            }
+                        }
+                        return (FlowStatus)cfs;
+                    }
+                    else if ( remote_side && (cfs = remote_side->read(remote_value, copy_old_data) ) )
                     {
                         if (cfs == CNewData || (cfs == COldData && copy_old_data)) {
                             internal::LateReferenceDataSource<T> ref_data_source(&sample);
@@ -349,6 +418,53 @@ namespace RTT {
                 return base::ChannelElement<T>::write(value_data_source.rvalue());
             }
 
+            /**
+             * CORBA IDL function.
+             */
+            bool writeSamples(const CSamples& samples) ACE_THROW_SPEC ((
+          	      CORBA::SystemException
+          	    ))
+            {
+                typename internal::ValueDataSource<T> value_data_source;
+                value_data_source.ref();
+                bool result = true;
+                for (CORBA::ULong i = 0; i != samples.length(); ++i) {
+                    transport.updateFromAny(&samples[i], &value_data_source);
+                    result = base::ChannelElement<T>::write(value_data_source.rvalue()) && result;
+                }
+                return result;
+            }
+
+            /**
+             * CORBA IDL function.
+             */
+            CFlowStatus readSamples(CSamples_out samples, ::CORBA::ULong max_samples, bool copy_old_data) ACE_THROW_SPEC ((
+          	      CORBA::SystemException
+          	    ))
+            {
+                FlowStatus result = NoData;
+                typename internal::ValueDataSource<T> value_data_source;
+                value_data_source.ref();
+                CSamples_var values = new CSamples();
+                while ( values->length() < max_samples ) {
+                    // old data is only returned if nothing new was read.
+                    FlowStatus fs = base::ChannelElement<T>::read(value_data_source.set(), copy_old_data && values->length() == 0);
+                    if ( fs == NoData || (fs == OldData && (values->length() != 0 || !copy_old_data)) ) {
+                        if ( values->length() == 0 )
+                            result = fs;
+                        break;
+                    }
+                    CORBA::ULong n = values->length();
+                    values->length(n + 1);
+                    transport.updateAny(&value_data_source, values[n]);
+                    result = fs;
+                    if ( fs == OldData )
+                        break;
+                }
+                samples = values._retn();
+                return (CFlowStatus)result;
+            }
+
             virtual bool data_sample(typename base::ChannelElement<T>::param_t sample)
             {
                 // we don't pass it on through CORBA (yet).
@@ -40,7 +40,10 @@
 
 namespace RTT {
     namespace mqueue {
-        Dispatcher::shared_ptr Dispatcher::DispatchI = 0;
+        const unsigned int Dispatcher::MaxShards;
+        unsigned int Dispatcher::defaultShards = 1;
+        unsigned int Dispatcher::Shards = 0;
+        Dispatcher::shared_ptr Dispatcher::DispatchI[Dispatcher::MaxShards];
         os::Mutex Dispatcher::DispatchILock;
 
         void intrusive_ptr_add_ref(const RTT::mqueue::Dispatcher* p ) {
@@ -36,13 +36,14 @@
  ***************************************************************************/
 
 
-
 #include "../../os/MutexLock.hpp"
 #include "../../Activity.hpp"
 #include "../../base/ChannelElementBase.hpp"
+#include "../../extras/FileDescriptorPoller.hpp"
 #include "../../Logger.hpp"
 #include <map>
-#include <sys/select.h>
+#include <sstream>
+#include <algorithm>
 #include <mqueue.h>
 
 namespace RTT { namespace mqueue { class Dispatcher; } }
@@ -56,27 +57,41 @@ namespace RTT {
          * This object waits on a set of open message queue
          * file descriptors and signals the channel that has
          * received new data.
-         * Reasonably, there should be one dispatcher for each
-         * peer component sending us data.
+         *
+         * The queues are spread over defaultShards dispatcher threads
+         * by descriptor. Each thread waits on its queues with a
+         * extras::FileDescriptorPoller, to which they are added and
+         * from which they are removed as the streams come and go.
          */
         class Dispatcher : public Activity
         {
             typedef boost::intrusive_ptr<Dispatcher> shared_ptr;
         public:
+            /**
+             * The maximum number of dispatcher threads.
+             */
+            static const unsigned int MaxShards = 16;
+
+            /**
+             * The number of dispatcher threads to spread the message
+             * queues over. This must be set before the first mqueue
+             * stream is created, later changes have no effect.
+             * Defaults to 1.
+             */
+            static unsigned int defaultShards;
 
             friend void intrusive_ptr_add_ref(const RTT::mqueue::Dispatcher* p );
             friend void intrusive_ptr_release(const RTT::mqueue::Dispatcher* p );
             mutable os::AtomicInt refcount;
 
             static os::Mutex DispatchILock;
-            static shared_ptr DispatchI;
+            static shared_ptr DispatchI[MaxShards];
+            static unsigned int Shards;
 
             typedef std::map<mqd_t,base::ChannelElementBase*> MQMap;
             MQMap mqmap;
 
-            fd_set socks;        /* Socket file descriptors we want to wake up for, using select() */
-
-            int highsock;        /* Highest #'d file descriptor, needed for select() */
+            extras::FileDescriptorPoller poller;
 
             bool do_exit;
 
@@ -84,63 +99,46 @@ namespace RTT {
 
             Dispatcher( const std::string& name)
             : Activity(ORO_SCHED_RT, os::HighestPriority, 0.0, 0, name),
-              highsock(0), do_exit(false)
+              do_exit(false)
               {}
 
             ~Dispatcher() {
                 Logger::In in("Dispatcher");
                 log(Info) << "Dispacher cleans up: no more work."<<endlog();
                 stop();
-                DispatchI = 0;
-            }
-
-            void build_select_list() {
-
-                /* First put together fd_set for select(), which will
-                   consist of the sock veriable in case a new connection
-                   is coming in, plus all the sockets we have already
-                   accepted. */
-
-
-                /* FD_ZERO() clears out the fd_set called socks, so that
-                    it doesn't contain any file descriptors. */
-
-                FD_ZERO(&socks);
-                highsock = 0;
-
-                /* Loops through all the possible connections and adds
-                    those sockets to the fd_set */
-                os::MutexLock lock(maplock);
-                for (MQMap::const_iterator it = mqmap.begin(); it != mqmap.end(); ++it) {
-                    FD_SET( it->first, &socks);
-                    if ( int(it->first) > highsock)
-                        highsock = int(it->first);
-                }
             }
 
             void read_socks() {
-                /* OK, now socks will be set with whatever socket(s)
-                   are ready for reading.*/
-
-                /* Run through our sockets and check to see if anything
-                    happened with them, if so 'service' them. */
+                /* Signal the channels of the queues that are ready.
+                   A queue removed since wait() returned is skipped. */
                 os::MutexLock lock(maplock);
-                for (MQMap::iterator it = mqmap.begin(); it != mqmap.end(); ++it) {
-                    if ( FD_ISSET( it->first, &socks) ) {
-                        //log(Debug) << "New data on " << it->first <<endlog();
-                        it->second->signal();
+                for (std::vector<int>::const_iterator it = poller.ready().begin(); it != poller.ready().end(); ++it) {
+                    MQMap::iterator mq = mqmap.find( *it );
+                    if ( mq != mqmap.end() ) {
+                        //log(Debug) << "New data on " << mq->first <<endlog();
+                        mq->second->signal();
                     }
                 }
             }
 
         public:
-            static Dispatcher::shared_ptr Instance() {
+            /**
+             * Returns the dispatcher that monitors \a mqdes.
+             */
+            static Dispatcher::shared_ptr Instance(mqd_t mqdes = 0) {
                 os::MutexLock lock(DispatchILock);
-                if (!DispatchI) {
-                    DispatchI = new Dispatcher("MQueueDispatch");
-                    DispatchI->start();
+                if (Shards == 0)
+                    Shards = std::max(1u, std::min(defaultShards, MaxShards));
+                unsigned int shard = (unsigned int)(mqdes) % Shards;
+                if (!DispatchI[shard]) {
+                    std::stringstream name;
+                    name << "MQueueDispatch";
+                    if (shard)
+                        name << shard;
+                    DispatchI[shard] = new Dispatcher(name.str());
+                    DispatchI[shard]->start();
                 }
-                return DispatchI;
+                return DispatchI[shard];
             }
 
             void addQueue( mqd_t mqdes, base::ChannelElementBase* chan ) {
@@ -152,8 +150,10 @@ namespace RTT {
                 log(Debug) <<"Dispatcher is monitoring mqdes "<< mqdes <<endlog();
                 os::MutexLock lock(maplock);
                 // we add a refcount per channel we monitor.
-                if (mqmap.count(mqdes) == 0)
+                if (mqmap.count(mqdes) == 0) {
                     refcount.inc();
+                    poller.add(mqdes);
+                }
                 mqmap[mqdes] = chan;
             }
 
@@ -162,6 +162,7 @@ namespace RTT {
                 log(Debug) <<"Dispatcher drops mqdes "<< mqdes <<endlog();
                 os::MutexLock lock(maplock);
                 if (mqmap.count(mqdes)) {
+                    poller.remove(mqdes);
                     mqmap.erase( mqmap.find(mqdes) );
                     refcount.dec();
                 }
@@ -169,42 +170,23 @@ namespace RTT {
 
             bool initialize() {
                 do_exit = false;
-                return true;
+                poller.clearWakeup();
+                return poller.isOpen();
             }
 
             void loop() {
-                struct timeval timeout;  /* Timeout for select */
-                int readsocks;       /* Number of sockets ready for reading */
-                while (1) { /* select loop */
-                    build_select_list();
-                    timeout.tv_sec = 0;
-                    timeout.tv_usec = 50000;
-
-                    /* The first argument to select is the highest file
-                        descriptor value plus 1.*/
-
-                    readsocks = select(highsock+1, &socks, (fd_set *) 0,
-                      (fd_set *) 0, &timeout);
-
-                    /* select() returns the number of sockets that had
-                        things going on with them -- i.e. they're readable. */
-
-                    /* Once select() returns, the original fd_set has been
-                        modified so it now reflects the state of why select()
-                        woke up. i.e. If file descriptor 4 was originally in
-                        the fd_set, and then it became readable, the fd_set
-                        contains file descriptor 4 in it. */
+                int readsocks;       /* Number of queues ready for reading */
+                while (1) { /* wait loop */
+                    readsocks = poller.wait();
 
                     if (readsocks < 0) {
                         if (errno != EINTR)
                         {
-                            log(Error) <<"Dispatcher failed to select on message queues. Stopped thread. error: "<<strerror(errno)<<endlog();
+                            log(Error) <<"Dispatcher failed to wait on message queues. Stopped thread. error: "<<strerror(errno)<<endlog();
                             return;
                         }
                     }
-                    else if (readsocks == 0) {
-                        // nop
-                    } else // readsocks > 0
+                    else if ( !poller.ready().empty() )
                         read_socks();
 
                     if ( do_exit )
@@ -214,9 +196,9 @@ namespace RTT {
 
             bool breakLoop() {
                 do_exit = true;
+                poller.wakeup();
                 return true;
             }
         };
     }
 }
-
@@ -92,6 +92,9 @@ namespace RTT
                         this->getOutput();
                     assert(output);
                     output->data_sample(read_sample->rvalue());
+                    // deliver the rest of a batch, if any.
+                    while (mqPending() && mqRead(read_sample))
+                        output->write(read_sample->rvalue());
                     return true;
                 }
                 return false;
@@ -107,7 +110,7 @@ namespace RTT
                     write_sample->setPointer(&sample);
                     // update MQSendRecv buffer:
                     mqNewSample(write_sample);
-                    return mqWrite(write_sample);
+                    return mqWrite(write_sample) && mqFlush();
                 }
                 return false;
             }
@@ -142,8 +145,14 @@ namespace RTT
                 } else {
                     typename base::ChannelElement<T>::shared_ptr output =
                         this->getOutput();
-                    if (output && mqRead(read_sample))
-                        return output->write(read_sample->rvalue());
+                    bool result = false;
+                    // a batched message may carry more than one sample.
+                    while (output && mqRead(read_sample)) {
+                        result = output->write(read_sample->rvalue());
+                        if (!mqPending())
+                            break;
+                    }
+                    return result;
                 }
                 return false;
             }
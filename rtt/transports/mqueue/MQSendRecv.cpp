@@ -55,14 +55,37 @@
 #include "../../base/PortInterface.hpp"
 #include "../../DataFlowInterface.hpp"
 #include "../../TaskContext.hpp"
+#include "../../os/MutexLock.hpp"
 
 using namespace RTT;
 using namespace RTT::detail;
 using namespace RTT::mqueue;
 
+namespace
+{
+    /**
+     * The header which precedes each sample in a batch.
+     */
+    struct BatchHeader
+    {
+        unsigned int size;
+        unsigned int reserved;
+    };
+
+    /**
+     * The space a sample of \a size bytes takes in a batch. It is
+     * rounded up such that each sample is aligned for any type.
+     */
+    int frameSize(int size)
+    {
+        return sizeof(BatchHeader) + ((size + 7) & ~7);
+    }
+}
+
 
 MQSendRecv::MQSendRecv(types::TypeMarshaller const& transport) :
-    mtransport(transport), marshaller_cookie(0), buf(0), mis_sender(false), minit_done(false), max_size(0), mdata_size(0)
+    mtransport(transport), marshaller_cookie(0), buf(0), mis_sender(false), minit_done(false), max_size(0), mdata_size(0),
+    mbatch(0), mbatch_buf(0), mbatch_capacity(0), mbatch_count(0), mbatch_pos(0), mbatch_end(0), mflusher(this), mengine(0)
 {
 }
 
@@ -75,6 +98,7 @@ void MQSendRecv::setupStream(base::DataSourceBase::shared_ptr ds, base::PortInte
     max_size = policy.data_size ? policy.data_size : mtransport.getSampleSize(ds);
     marshaller_cookie = mtransport.createCookie();
     mis_sender = is_sender;
+    mbatch = policy.batch > 1 ? policy.batch : 0;
 
     if (policy.name_id.empty())
     {
@@ -90,7 +114,7 @@ void MQSendRecv::setupStream(base::DataSourceBase::shared_ptr ds, base::PortInte
 
     struct mq_attr mattr;
     mattr.mq_maxmsg = policy.size ? policy.size : 10;
-    mattr.mq_msgsize = max_size;
+    mattr.mq_msgsize = mbatch ? mbatch * frameSize(max_size) : max_size;
     assert( max_size );
     if (policy.name_id[0] != '/')
         throw std::runtime_error("Could not open message queue with wrong name. Names must start with '/' and contain no more '/' after the first one.");
@@ -148,6 +172,26 @@ void MQSendRecv::setupStream(base::DataSourceBase::shared_ptr ds, base::PortInte
     buf = new char[max_size];
     memset(buf, 0, max_size); // necessary to trick valgrind
     mqname = policy.name_id;
+
+    if (mbatch)
+    {
+        // the queue may have been created by the other side.
+        if (mq_getattr(mqdes, &mattr) == 0)
+            mbatch_capacity = mattr.mq_msgsize;
+        else
+            mbatch_capacity = mbatch * frameSize(max_size);
+        mbatch_buf = new char[mbatch_capacity];
+        memset(mbatch_buf, 0, mbatch_capacity);
+        if (mis_sender)
+        {
+            if (port->getInterface() && port->getInterface()->getOwner())
+                mengine = port->getInterface()->getOwner()->engine();
+            if (mengine)
+                mengine->addUpdateListener(&mflusher);
+            else
+                log(Warning) << "Port " << port->getName() << " is not part of a component: batches on '" << mqname << "' are only sent when full." << endlog();
+        }
+    }
 }
 
 MQSendRecv::~MQSendRecv()
@@ -158,11 +202,18 @@ MQSendRecv::~MQSendRecv()
 
 void MQSendRecv::cleanupStream()
 {
+    if (mengine)
+    {
+        mengine->removeUpdateListener(&mflusher);
+        mengine = 0;
+    }
+    mqFlush();
+
     if (!mis_sender)
     {
         if (minit_done)
         {
-            Dispatcher::Instance()->removeQueue(mqdes);
+            Dispatcher::Instance(mqdes)->removeQueue(mqdes);
             minit_done = false;
         }
     }
@@ -182,6 +233,8 @@ void MQSendRecv::cleanupStream()
         delete[] buf;
         buf = 0;
     }
+    delete[] mbatch_buf;
+    mbatch_buf = 0;
 }
 
 
@@ -212,14 +265,22 @@ bool MQSendRecv::mqReady(base::DataSourceBase::shared_ptr ds, base::ChannelEleme
         abs_timeout.tv_sec += abs_timeout.tv_nsec / (1000*1000*1000);
         abs_timeout.tv_nsec = abs_timeout.tv_nsec % (1000*1000*1000);
         //abs_timeout.tv_sec +=1;
-        ssize_t ret = mq_timedreceive(mqdes, buf, max_size, 0, &abs_timeout);
+        ssize_t ret;
+        if (mbatch)
+        {
+            ret = mq_timedreceive(mqdes, mbatch_buf, mbatch_capacity, 0, &abs_timeout);
+            mbatch_pos = 0;
+            mbatch_end = ret != -1 ? ret : 0;
+        }
+        else
+            ret = mq_timedreceive(mqdes, buf, max_size, 0, &abs_timeout);
         if (ret != -1)
         {
-            if (mtransport.updateFromBlob((void*) buf, ret, ds, marshaller_cookie))
+            if (mbatch ? mqUnpack(ds) : mtransport.updateFromBlob((void*) buf, ret, ds, marshaller_cookie))
             {
                 minit_done = true;
                 // ok, now we can add the dispatcher.
-                Dispatcher::Instance()->addQueue(mqdes, chan);
+                Dispatcher::Instance(mqdes)->addQueue(mqdes, chan);
                 return true;
             }
             else
@@ -245,6 +306,19 @@ bool MQSendRecv::mqReady(base::DataSourceBase::shared_ptr ds, base::ChannelEleme
 
 bool MQSendRecv::mqRead(RTT::base::DataSourceBase::shared_ptr ds)
 {
+    if (mbatch)
+    {
+        if (!mqPending())
+        {
+            int bytes = mq_receive(mqdes, mbatch_buf, mbatch_capacity, 0);
+            if (bytes == -1)
+                return false;
+            mbatch_pos = 0;
+            mbatch_end = bytes;
+        }
+        return mqUnpack(ds);
+    }
+
     int bytes = 0;
     if ((bytes = mq_receive(mqdes, buf, max_size, 0)) == -1)
     {
@@ -258,24 +332,91 @@ bool MQSendRecv::mqRead(RTT::base::DataSourceBase::shared_ptr ds)
     return false;
 }
 
-bool MQSendRecv::mqWrite(RTT::base::DataSourceBase::shared_ptr ds)
+bool MQSendRecv::mqUnpack(RTT::base::DataSourceBase::shared_ptr ds)
 {
-    std::pair<void const*, int> blob = mtransport.fillBlob(ds, buf, max_size, marshaller_cookie);
-    if (blob.first == 0)
+    BatchHeader header;
+    if (mbatch_end - mbatch_pos < int(sizeof(BatchHeader)))
     {
-        log(Error) << "MQChannel: failed to marshal sample" << endlog();
+        mbatch_pos = mbatch_end;
+        return false;
+    }
+    memcpy(&header, mbatch_buf + mbatch_pos, sizeof(BatchHeader));
+    if (int(header.size) > mbatch_end - mbatch_pos - int(sizeof(BatchHeader)))
+    {
+        log(Error) << "MQChannel "<< mqdes << " received a corrupt batch of length " << mbatch_end << endlog();
+        mbatch_pos = mbatch_end;
         return false;
     }
+    char* sample = mbatch_buf + mbatch_pos + sizeof(BatchHeader);
+    mbatch_pos += frameSize(header.size);
+    if (mbatch_pos > mbatch_end)
+        mbatch_pos = mbatch_end;
+    return mtransport.updateFromBlob((void*) sample, header.size, ds, marshaller_cookie);
+}
 
-    char* lbuf = (char*) blob.first;
-    if (mq_send(mqdes, lbuf, blob.second, 0) == -1)
+bool MQSendRecv::mqSend(const char* data, int size)
+{
+    if (mq_send(mqdes, data, size, 0) == -1)
     {
         if (errno == EAGAIN)
             return true;
 
-        log(Error) << "MQChannel "<< mqdes << " became invalid (mq length="<<max_size<<", msg length="<<blob.second<<"): " << strerror(errno) << endlog();
+        log(Error) << "MQChannel "<< mqdes << " became invalid (mq length="<<max_size<<", msg length="<<size<<"): " << strerror(errno) << endlog();
         return false;
     }
     return true;
 }
 
+bool MQSendRecv::mqFlush()
+{
+    if (!mbatch || !mis_sender)
+        return true;
+    os::MutexLock lock(mbatch_lock);
+    if (mbatch_count == 0)
+        return true;
+    bool result = mqSend(mbatch_buf, mbatch_pos);
+    mbatch_count = 0;
+    mbatch_pos = 0;
+    return result;
+}
+
+bool MQSendRecv::mqWrite(RTT::base::DataSourceBase::shared_ptr ds)
+{
+    std::pair<void const*, int> blob = mtransport.fillBlob(ds, buf, max_size, marshaller_cookie);
+    if (blob.first == 0)
+    {
+        log(Error) << "MQChannel: failed to marshal sample" << endlog();
+        return false;
+    }
+
+    if (!mbatch)
+        return mqSend((const char*) blob.first, blob.second);
+
+    os::MutexLock lock(mbatch_lock);
+    int frame = frameSize(blob.second);
+    if (frame > mbatch_capacity)
+    {
+        log(Error) << "MQChannel "<< mqdes << ": sample of length " << blob.second << " does not fit in a batch of length " << mbatch_capacity << endlog();
+        return false;
+    }
+    bool result = true;
+    if (mbatch_pos + frame > mbatch_capacity)
+    {
+        result = mqSend(mbatch_buf, mbatch_pos);
+        mbatch_count = 0;
+        mbatch_pos = 0;
+    }
+    BatchHeader header;
+    header.size = blob.second;
+    header.reserved = 0;
+    memcpy(mbatch_buf + mbatch_pos, &header, sizeof(BatchHeader));
+    memcpy(mbatch_buf + mbatch_pos + sizeof(BatchHeader), blob.first, blob.second);
+    mbatch_pos += frame;
+    if (++mbatch_count == mbatch)
+    {
+        result = mqSend(mbatch_buf, mbatch_pos) && result;
+        mbatch_count = 0;
+        mbatch_pos = 0;
+    }
+    return result;
+}
@@ -42,6 +42,8 @@
 #include <mqueue.h>
 #include "../../rtt-fwd.hpp"
 #include "../../base/DataSourceBase.hpp"
+#include "../../base/ExecutableInterface.hpp"
+#include "../../os/Mutex.hpp"
 
 namespace RTT
 {
@@ -101,6 +103,41 @@ namespace RTT
              */
             int mdata_size;
 
+            /**
+             * Batching: up to mbatch samples are packed in one message of
+             * mbatch_capacity bytes. Each sample is preceded by its length and
+             * padded to a multiple of eight bytes.
+             */
+            int mbatch;
+            char* mbatch_buf;
+            int mbatch_capacity;
+            int mbatch_count;
+            int mbatch_pos;
+            int mbatch_end;
+            os::Mutex mbatch_lock;
+
+            /**
+             * Flushes the batch after each updateHook() of the writing component.
+             */
+            struct Flusher : public base::ExecutableInterface
+            {
+                MQSendRecv* mq;
+                Flusher(MQSendRecv* mq) : mq(mq) {}
+                bool execute() { mq->mqFlush(); return true; }
+            };
+            Flusher mflusher;
+            ExecutionEngine* mengine;
+
+            /**
+             * Sends one message.
+             */
+            bool mqSend(const char* data, int size);
+
+            /**
+             * Reads the next sample of the batch which was received last.
+             */
+            bool mqUnpack(base::DataSourceBase::shared_ptr ds);
+
         public:
             /**
              * Create a channel element for remote data exchange.
@@ -141,7 +178,21 @@ namespace RTT
              * @param is_data_sample true if the sample is used for initialization, false if it is a proper write
              * @return true if it could be sent.
              */
+            /**
+             * Sends \a ds, or adds it to the current batch if batching is enabled.
+             */
             bool mqWrite(base::DataSourceBase::shared_ptr ds);
+
+            /**
+             * Sends the current batch, if any.
+             */
+            bool mqFlush();
+
+            /**
+             * Returns true if the batch which was received last contains samples
+             * which were not yet read with mqRead().
+             */
+            bool mqPending() const { return !mis_sender && mbatch_pos != mbatch_end; }
         };
     }
 }
@@ -0,0 +1,78 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public                   *
+ *   License as published by the Free Software Foundation;                 *
+ *   version 2 of the License.                                             *
+ *                                                                         *
+ *   As a special exception, you may use this file as part of a free       *
+ *   software library without restriction.  Specifically, if other files   *
+ *   instantiate templates or use macros or inline functions from this     *
+ *   file, or you compile this file and link it with other files to        *
+ *   produce an executable, this file does not by itself cause the         *
+ *   resulting executable to be covered by the GNU General Public          *
+ *   License.  This exception does not however invalidate any other        *
+ *   reasons why the executable file might be covered by the GNU General   *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public             *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef ORO_EXECUTIONSTATISTICSTYPE_HPP_
+#define ORO_EXECUTIONSTATISTICSTYPE_HPP_
+
+#include <boost/version.hpp>
+#if BOOST_VERSION >= 106400
+# include <boost/serialization/array_wrapper.hpp>
+#else
+# include <boost/serialization/array.hpp>
+#endif
+#include <boost/serialization/serialization.hpp>
+#include "../ExecutionStatistics.hpp"
+
+namespace boost {
+    namespace serialization {
+        /**
+         * Serializes RTT::ExecutionStatistics objects.
+         * @param a Any boost::serialization compatible archive
+         * @param s The ExecutionStatistics that will be read or written.
+         */
+        template<class Archive>
+        void serialize(Archive& a, RTT::ExecutionStatistics& s, unsigned int) {
+            a & boost::serialization::make_nvp("cycles", s.cycles);
+            a & boost::serialization::make_nvp("updates", s.updates);
+            a & boost::serialization::make_nvp("messages_mean", s.messages_mean);
+            a & boost::serialization::make_nvp("messages_max", s.messages_max);
+            a & boost::serialization::make_nvp("callbacks_mean", s.callbacks_mean);
+            a & boost::serialization::make_nvp("callbacks_max", s.callbacks_max);
+            a & boost::serialization::make_nvp("functions_mean", s.functions_mean);
+            a & boost::serialization::make_nvp("functions_max", s.functions_max);
+            a & boost::serialization::make_nvp("hook_mean", s.hook_mean);
+            a & boost::serialization::make_nvp("hook_max", s.hook_max);
+            a & boost::serialization::make_nvp("hook_histogram",
+                    boost::serialization::make_array(s.hook_histogram, RTT::ExecutionStatistics::HistogramBins));
+            a & boost::serialization::make_nvp("period", s.period);
+            a & boost::serialization::make_nvp("jitter_mean", s.jitter_mean);
+            a & boost::serialization::make_nvp("jitter_max", s.jitter_max);
+            a & boost::serialization::make_nvp("overruns", s.overruns);
+            a & boost::serialization::make_nvp("messages_depth_max", s.messages_depth_max);
+            a & boost::serialization::make_nvp("callbacks_depth_max", s.callbacks_depth_max);
+            a & boost::serialization::make_nvp("functions_depth_max", s.functions_depth_max);
+        }
+    }
+}
+
+
+#endif /* ORO_EXECUTIONSTATISTICSTYPE_HPP_ */
@@ -46,11 +46,13 @@
 #include "../types/SequenceTypeInfo.hpp"
 #include "StdTypeInfo.hpp"
 #include "../types/StructTypeInfo.hpp"
+#include "../types/CArrayTypeInfo.hpp"
 
 #include "../rtt-fwd.hpp"
 #include "../FlowStatus.hpp"
 #include "../ConnPolicy.hpp"
 #include "ConnPolicyType.hpp"
+#include "ExecutionStatisticsType.hpp"
 #include "TaskContext.hpp"
 
 namespace RTT
@@ -71,6 +73,8 @@ namespace RTT
              ti->addType( new StdTypeInfo<SendStatus>("SendStatus"));
              ti->addType( new TemplateTypeInfo<PropertyBag, true>("PropertyBag") );
              ti->addType( new StructTypeInfo<ConnPolicy>("ConnPolicy") );
+             ti->addType( new CArrayTypeInfo< carray<unsigned int> >("uint[]") );
+             ti->addType( new StructTypeInfo<ExecutionStatistics>("ExecutionStatistics") );
              ti->addType( new TemplateTypeInfo<EmptySendHandle>("SendHandle") ); //dummy, replaced by real stuff when seen by parser.
              ti->addType( new TemplateTypeInfo<TaskContext*>("TaskContext"));
          }
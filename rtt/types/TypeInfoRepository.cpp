@@ -45,7 +45,10 @@
 #include "TransportPlugin.hpp"
 #include "../internal/mystd.hpp"
 #include "../internal/DataSourceTypeInfo.hpp"
+#include "../os/CAS.hpp"
+#include "../os/Atomic.hpp"
 #include <boost/algorithm/string.hpp>
+#include <cstring>
 
 namespace RTT
 {
@@ -54,9 +57,89 @@ namespace RTT
 
     namespace {
         boost::shared_ptr<TypeInfoRepository> typerepos;
+
+        /**
+         * Incremented each time types are added or the repository is
+         * released, which invalidates all TypeIdCache objects.
+         */
+        os::AtomicInt type_generation(1);
     }
 
+    /**
+     * An open addressing hash table with linear probing, keyed on
+     * type id names. Slots are filled by writing the TypeInfo pointer
+     * before the name, such that readers which find a name also find
+     * its TypeInfo. Slots are never removed.
+     */
+    struct TypeInfoRepository::TypeIdIndex
+    {
+        struct Slot {
+            const char* volatile name;
+            TypeInfo* volatile info;
+        };
+        Slot* slots;
+        unsigned int mask;
+        unsigned int used;
+
+        /**
+         * @param size A power of two.
+         */
+        TypeIdIndex(unsigned int size)
+            : slots( new Slot[size] ), mask( size - 1 ), used(0)
+        {
+            for (unsigned int i = 0; i != size; ++i) {
+                slots[i].name = 0;
+                slots[i].info = 0;
+            }
+        }
+
+        ~TypeIdIndex()
+        {
+            delete[] slots;
+        }
+
+        static unsigned int hash(const char* name)
+        {
+            // FNV-1a
+            unsigned int h = 2166136261u;
+            for (; *name; ++name)
+                h = (h ^ (unsigned char)*name) * 16777619u;
+            return h;
+        }
+
+        TypeInfo* find(const char* name) const
+        {
+            for (unsigned int i = hash(name) & mask; ; i = (i + 1) & mask) {
+                const char* n = slots[i].name;
+                if ( n == 0 )
+                    return 0;
+                if ( n == name || strcmp(n, name) == 0 )
+                    return slots[i].info;
+            }
+        }
+
+        /**
+         * Adds \a info under \a name, unless the name is already present.
+         * @return false if the table must grow first.
+         */
+        bool insert(const char* name, TypeInfo* info)
+        {
+            unsigned int i = hash(name) & mask;
+            for (; slots[i].name != 0; i = (i + 1) & mask)
+                if ( strcmp(slots[i].name, name) == 0 )
+                    return true;
+            // keep at least half of the slots free.
+            if ( 2 * (used + 1) > mask + 1 )
+                return false;
+            slots[i].info = info;
+            os::CAS(&slots[i].name, (const char*)0, name);
+            ++used;
+            return true;
+        }
+    };
+
     TypeInfoRepository::TypeInfoRepository()
+        : type_ids( new TypeIdIndex(256) )
     {
     }
 
@@ -71,6 +154,7 @@ namespace RTT
 
     void TypeInfoRepository::Release() {
         typerepos.reset();
+        type_generation.inc();
     }
     
     void TypeInfoRepository::setAutoLoader(const boost::function<bool (const std::string &)> &loader)
@@ -134,30 +218,51 @@ namespace RTT
             delete *begin;
         delete DataSourceTypeInfo<UnknownType>::TypeInfoObject;
         DataSourceTypeInfo<UnknownType>::TypeInfoObject = 0;
+        delete type_ids;
+        for (vector<TypeIdIndex*>::iterator it = retired_type_ids.begin(); it != retired_type_ids.end(); ++it)
+            delete *it;
+    }
+
+    void TypeInfoRepository::indexTypeId( TypeInfo* ti )
+    {
+        if ( !ti->getTypeId() )
+            return;
+        if ( !type_ids->insert( ti->getTypeIdName(), ti ) ) {
+            // grow, then publish the new index to the readers.
+            TypeIdIndex* old = type_ids;
+            TypeIdIndex* bigger = new TypeIdIndex( 2 * (old->mask + 1) );
+            for (unsigned int i = 0; i <= old->mask; ++i)
+                if ( old->slots[i].name )
+                    bigger->insert( old->slots[i].name, old->slots[i].info );
+            bigger->insert( ti->getTypeIdName(), ti );
+            os::CAS(&type_ids, old, bigger);
+            retired_type_ids.push_back( old );
+        }
+        type_generation.inc();
     }
 
     TypeInfo* TypeInfoRepository::getTypeById(TypeInfo::TypeId type_id) const {
       if (!type_id)
           return 0;
-      MutexLock lock(type_lock);
-      // Ask each type for its type id name.
-      map_t::const_iterator i = data.begin();
-      for (; i != data.end(); ++i){
-        if (i->second->getTypeId() && *(i->second->getTypeId()) == *type_id)
-          return i->second;
-      }
-      return 0;
+      return type_ids->find( type_id->name() );
     }
 
     TypeInfo* TypeInfoRepository::getTypeById(const char * type_id_name) const {
-      // Ask each type for its type id name.
-      MutexLock lock(type_lock);
-      map_t::const_iterator i = data.begin();
-      for (; i != data.end(); ++i){
-        if (i->second->getTypeId() && i->second->getTypeId()->name() == type_id_name)
-          return i->second;
+      if (!type_id_name)
+          return 0;
+      return type_ids->find( type_id_name );
+    }
+
+    TypeInfo* TypeInfoRepository::getTypeById(TypeInfo::TypeId type_id, TypeIdCache& cache) const {
+      int generation = type_generation.read();
+      if ( cache.info && cache.generation == generation )
+          return cache.info;
+      TypeInfo* ret = getTypeById( type_id );
+      if ( ret ) {
+          cache.info = ret;
+          cache.generation = generation;
       }
-      return 0;
+      return ret;
     }
 
     bool TypeInfoRepository::addType(TypeInfo* t)
@@ -171,6 +276,7 @@ namespace RTT
         }
 
         data[t->getTypeName()] = t;
+        indexTypeId( t );
         return true;
     }
 
@@ -200,6 +306,7 @@ namespace RTT
         MutexLock lock(type_lock);
         // keep track of this type:
         data[ tname ] = ti;
+        indexTypeId( ti );
 
         log(Debug) << "Registered Type '"<<tname <<"' to the Orocos Type System."<<Logger::endl;
         for(Transports::iterator it = transports.begin(); it != transports.end(); ++it)
@@ -64,6 +64,22 @@ namespace RTT
         mutable os::Mutex type_lock;
         
         boost::function<bool (const std::string &)> loadTypeKitForName;
+
+        /**
+         * Hash index from type id names to the registered types.
+         * It is only modified with type_lock held, but can be
+         * read without taking it. Indexes which were replaced
+         * because they grew are kept in retired_type_ids until
+         * this object is destroyed.
+         */
+        struct TypeIdIndex;
+        TypeIdIndex* volatile type_ids;
+        std::vector<TypeIdIndex*> retired_type_ids;
+
+        /**
+         * Adds \a ti to type_ids. Must be called with type_lock held.
+         */
+        void indexTypeId( TypeInfo* ti );
         
         TypeInfo* typeInternal( const std::string& name ) const;
     public:
@@ -126,12 +142,29 @@ namespace RTT
          */
         TypeInfo* getTypeById(const char * type_id_name) const;
 
+        /**
+         * Remembers the result of a getTypeById() call, such that it
+         * need not be repeated until new types are added.
+         */
+        struct TypeIdCache {
+            TypeInfo* info;
+            int generation;
+        };
+
+        /**
+         * Return the type info structure of a given type by its type_id,
+         * using and updating \a cache. Only types which were found are
+         * cached.
+         */
+        TypeInfo* getTypeById(TypeInfo::TypeId type_id, TypeIdCache& cache) const;
+
         /**
          * Return the type info structure of a given type T.
          */
         template<class T>
         TypeInfo* getTypeInfo() const {
-            return getTypeById( &typeid(T) );
+            static TypeIdCache cache = { 0, 0 };
+            return getTypeById( &typeid(T), cache );
         }
 
         /**
@@ -23,6 +23,7 @@
 
 #include <internal/AtomicQueue.hpp>
 #include <internal/AtomicMWSRQueue.hpp>
+#include <internal/AtomicRingBuffer.hpp>
 
 #include <Activity.hpp>
 
@@ -695,6 +696,110 @@ struct AQEater : public RunnableInterface
 };
 
 
+/**
+ * The data path of the TsPool based BufferLockFree: each
+ * value is copied in a pool item of which the pointer is queued.
+ */
+template<class T>
+struct PooledQueue
+{
+    AtomicMWSRQueue<T*> queue;
+    TsPool<T> pool;
+    PooledQueue(int size) : queue(size), pool(size + 1) {}
+    bool enqueue(const T& value) {
+        T* item = pool.allocate();
+        if (item == 0)
+            return false;
+        *item = value;
+        if ( queue.enqueue(item) )
+            return true;
+        pool.deallocate(item);
+        return false;
+    }
+    bool dequeue(T& value) {
+        T* item;
+        if ( !queue.dequeue(item) )
+            return false;
+        value = *item;
+        pool.deallocate(item);
+        return true;
+    }
+    int size() const { return queue.size(); }
+};
+
+/**
+ * Enqueues values as fast as possible.
+ */
+template<class Q>
+struct QueueProducer : public RunnableInterface
+{
+    volatile bool stop;
+    Q* mq;
+    long count;
+    QueueProducer(Q* q) : stop(false), mq(q), count(0) {}
+    bool initialize() { stop = false; return true; }
+    void step() {
+        Dummy d(1,2,3);
+        while (stop == false )
+            if ( mq->enqueue(d) )
+                ++count;
+    }
+    void finalize() {}
+    bool breakLoop() { stop = true; return true; }
+};
+
+/**
+ * Dequeues values as fast as possible.
+ */
+template<class Q>
+struct QueueConsumer : public RunnableInterface
+{
+    volatile bool stop;
+    Q* mq;
+    long count;
+    bool corrupt;
+    QueueConsumer(Q* q) : stop(false), mq(q), count(0), corrupt(false) {}
+    bool initialize() { stop = false; return true; }
+    void step() {
+        Dummy d;
+        while (stop == false )
+            if ( mq->dequeue(d) ) {
+                corrupt = corrupt || d != Dummy(1,2,3);
+                ++count;
+            }
+    }
+    void finalize() {}
+    bool breakLoop() { stop = true; return true; }
+};
+
+/**
+ * Measures the throughput of three writers and one reader of \a q.
+ */
+template<class Q>
+void testQueueThroughput(Q& q, const char* name)
+{
+    QueueProducer<Q> p1(&q), p2(&q), p3(&q);
+    QueueConsumer<Q> consumer(&q);
+    {
+        boost::scoped_ptr<Activity> athread( new Activity(ORO_SCHED_OTHER, 0, 0, &p1, "ProducerA" ));
+        boost::scoped_ptr<Activity> bthread( new Activity(ORO_SCHED_OTHER, 0, 0, &p2, "ProducerB" ));
+        boost::scoped_ptr<Activity> cthread( new Activity(ORO_SCHED_OTHER, 0, 0, &p3, "ProducerC" ));
+        boost::scoped_ptr<Activity> ethread( new Activity(ORO_SCHED_OTHER, 0, 0, &consumer, "Consumer" ));
+        ethread->start();
+        athread->start();
+        bthread->start();
+        cthread->start();
+        sleep(2);
+        athread->stop();
+        bthread->stop();
+        cthread->stop();
+        ethread->stop();
+    }
+    BOOST_CHECK( !consumer.corrupt );
+    BOOST_CHECK_EQUAL( p1.count + p2.count + p3.count, consumer.count + q.size() );
+    cout << name << ": " << consumer.count / 2 << " samples/s" << endl;
+}
+
 BOOST_FIXTURE_TEST_SUITE( BuffersAtomicTestSuite, BuffersAQueueTest )
 
 BOOST_AUTO_TEST_CASE( testAtomicQueue )
@@ -785,6 +890,67 @@ BOOST_AUTO_TEST_CASE( testAtomicMWSRQueue )
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( BuffersRingBufferTestSuite )
+
+BOOST_AUTO_TEST_CASE( testAtomicRingBuffer )
+{
+    AtomicRingBuffer<int> rb(QS);
+    int v = -1;
+    BOOST_REQUIRE_EQUAL( AtomicRingBuffer<int>::size_type(QS), rb.capacity() );
+    BOOST_CHECK( rb.isEmpty() );
+    BOOST_CHECK( rb.dequeue(v) == false );
+    BOOST_CHECK_EQUAL( v, -1 );
+
+    // wrap around the ring several times.
+    for (int lap = 0; lap != 3; ++lap) {
+        for (int i = 0; i != QS; ++i) {
+            BOOST_CHECK( rb.enqueue(i) );
+            BOOST_CHECK_EQUAL( rb.size(), AtomicRingBuffer<int>::size_type(i + 1) );
+        }
+        BOOST_CHECK( rb.isFull() );
+        BOOST_CHECK( rb.enqueue(QS) == false );
+        for (int i = 0; i != QS; ++i) {
+            BOOST_CHECK( rb.dequeue(v) );
+            BOOST_CHECK_EQUAL( v, i );
+        }
+        BOOST_CHECK( rb.isEmpty() );
+        BOOST_CHECK( rb.enqueue(lap) );
+        BOOST_CHECK( rb.dequeue(v) );
+        BOOST_CHECK_EQUAL( v, lap );
+    }
+
+    // batches are partially done when the queue is full or empty.
+    int in[QS + 5], out[QS + 5];
+    for (int i = 0; i != QS + 5; ++i)
+        in[i] = i;
+    BOOST_CHECK_EQUAL( rb.enqueue(in, 3), AtomicRingBuffer<int>::size_type(3) );
+    BOOST_CHECK_EQUAL( rb.enqueue(in + 3, QS + 2), AtomicRingBuffer<int>::size_type(QS - 3) );
+    BOOST_CHECK_EQUAL( rb.dequeue(out, 4), AtomicRingBuffer<int>::size_type(4) );
+    BOOST_CHECK_EQUAL( rb.dequeue(out + 4, QS + 5), AtomicRingBuffer<int>::size_type(QS - 4) );
+    for (int i = 0; i != QS; ++i)
+        BOOST_CHECK_EQUAL( out[i], i );
+    BOOST_CHECK( rb.isEmpty() );
+
+    rb.enqueue(in, 5);
+    rb.clear();
+    BOOST_CHECK( rb.isEmpty() );
+    BOOST_CHECK( rb.dequeue(v) == false );
+
+    // null pointers can be stored, a zero sized queue never accepts items.
+    AtomicRingBuffer<Dummy*, false, false> prb(1);
+    Dummy* d = new Dummy();
+    BOOST_CHECK( prb.enqueue(0) );
+    BOOST_CHECK( prb.enqueue(d) == false );
+    BOOST_CHECK( prb.dequeue(d) );
+    BOOST_CHECK( d == 0 );
+    AtomicRingBuffer<int> zrb(0);
+    BOOST_CHECK_EQUAL( zrb.capacity(), AtomicRingBuffer<int>::size_type(0) );
+    BOOST_CHECK( zrb.enqueue(1) == false );
+    BOOST_CHECK( zrb.dequeue(v) == false );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_FIXTURE_TEST_SUITE( BuffersDataFlowTestSuite, BuffersDataFlowTest )
 
 BOOST_AUTO_TEST_CASE( testBufLockFree )
@@ -1155,5 +1321,51 @@ BOOST_AUTO_TEST_CASE( testAtomicMWSRQueue )
     delete grower;
     delete eater;
 }
+
+BOOST_AUTO_TEST_CASE( testAtomicRingBuffer )
+{
+    AtomicRingBuffer<Dummy*> qt(QS);
+    AQWorker< AtomicRingBuffer<Dummy*> > aworker( &qt ), bworker( &qt ), cworker( &qt );
+    AQGrower< AtomicRingBuffer<Dummy*> > grower( &qt );
+    AQEater< AtomicRingBuffer<Dummy*> > eater( &qt );
+    {
+        boost::scoped_ptr<Activity> athread( new Activity(ORO_SCHED_OTHER, 0, 0, &aworker, "ActivityA" ));
+        boost::scoped_ptr<Activity> bthread( new Activity(ORO_SCHED_OTHER, 0, 0, &bworker, "ActivityB" ));
+        boost::scoped_ptr<Activity> cthread( new Activity(ORO_SCHED_OTHER, 0, 0, &cworker, "ActivityC" ));
+        boost::scoped_ptr<Activity> gthread( new Activity(ORO_SCHED_OTHER, 0, 0, &grower, "ActivityG" ));
+        boost::scoped_ptr<Activity> ethread( new Activity(ORO_SCHED_OTHER, 0, 0, &eater, "ActivityE" ));
+
+        log(Info) <<"Stressing multi-write/multi-read..." <<endlog();
+        athread->start();
+        bthread->start();
+        cthread->start();
+        gthread->start();
+        ethread->start();
+        sleep(3);
+        athread->stop();
+        bthread->stop();
+        cthread->stop();
+        gthread->stop();
+        ethread->stop();
+    }
+    int appends = aworker.appends + bworker.appends + cworker.appends + grower.appends;
+    int erases = aworker.erases + bworker.erases + cworker.erases + eater.erases;
+    cout << "Total appends: " << appends << endl;
+    cout << "Total erases : " << erases << endl;
+    BOOST_CHECK_EQUAL( appends, erases + int(qt.size()) );
+    qt.clear();
+    BOOST_CHECK( qt.isEmpty() );
+}
+
+BOOST_AUTO_TEST_CASE( testRingBufferThroughput )
+{
+    // a large queue, such that the threads rarely wait for each other.
+    PooledQueue<Dummy> pooled(1024);
+    AtomicRingBuffer<Dummy, true, false> mwsr(1024);
+    AtomicRingBuffer<Dummy> mwmr(1024);
+    testQueueThroughput( pooled, "AtomicMWSRQueue + TsPool" );
+    testQueueThroughput( mwsr, "AtomicRingBuffer (multi-writer/single-reader)" );
+    testQueueThroughput( mwmr, "AtomicRingBuffer (multi-writer/multi-reader)" );
+}
 #endif
 BOOST_AUTO_TEST_SUITE_END()
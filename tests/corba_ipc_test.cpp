@@ -696,5 +696,107 @@ BOOST_AUTO_TEST_CASE( testBufferHalfs )
     BOOST_CHECK_EQUAL( result, 4.44);
 }
 
+BOOST_AUTO_TEST_CASE( testBatchHalfs )
+{
+    double result;
+
+    // This test tests transferring several samples per call.
+    tp = corba::TaskContextProxy::Create( "peerBB" , /* is_ior = */ false);
+    if (!tp )
+        tp = corba::TaskContextProxy::CreateFromFile( "peerBB.ior");
+
+    s = tp->server();
+
+    // Create a default CORBA policy specification
+    RTT::corba::CConnPolicy policy = toCORBA(ConnPolicy::buffer(10));
+    policy.init = false;
+    policy.transport = ORO_CORBA_PROTOCOL_ID; // force creation of non-local connections
+
+    corba::CDataFlowInterface_var ports  = s->ports();
+    BOOST_REQUIRE( ports.in() );
+
+    // test C++ write --> batched Corba read
+    policy.pull = false;
+    mo->connectTo( tp->ports()->getPort("mi"), toRTT(policy) );
+    CChannelElement_var cce = ports->buildChannelInput("mo", policy);
+    BOOST_REQUIRE( cce.in() );
+    CRemoteBatchChannelElement_var bce = CRemoteBatchChannelElement::_narrow( cce.in() );
+    BOOST_REQUIRE( !CORBA::is_nil( bce.in() ) );
+
+    CSamples_var samples;
+    for (int i = 0; i != 5; ++i)
+        mo->write( i + 0.5 );
+    std::vector<double> received;
+    for (int wait = 0; received.size() < 5 && wait != 10; ++wait) {
+        if ( bce->readSamples( samples.out(), 3, false ) == CNewData ) {
+            BOOST_CHECK( samples->length() <= 3u );
+            for (CORBA::ULong i = 0; i != samples->length(); ++i) {
+                BOOST_CHECK( samples[i] >>= result );
+                received.push_back( result );
+            }
+        } else
+            usleep(100000);
+    }
+    BOOST_REQUIRE_EQUAL( received.size(), 5u );
+    for (int i = 0; i != 5; ++i)
+        BOOST_CHECK_EQUAL( received[i], i + 0.5 );
+
+    // Check re-read of old data, which returns one sample.
+    BOOST_CHECK_EQUAL( bce->readSamples( samples.out(), 3, false ), COldData );
+    BOOST_CHECK_EQUAL( samples->length(), 0u );
+    BOOST_CHECK_EQUAL( bce->readSamples( samples.out(), 3, true ), COldData );
+    BOOST_REQUIRE_EQUAL( samples->length(), 1u );
+    BOOST_CHECK( samples[0] >>= result );
+    BOOST_CHECK_EQUAL( result, 4.5 );
+
+    cce->disconnect();
+    mo->disconnect();
+
+    // test batched Corba write --> C++ read
+    mi->connectTo( tp->ports()->getPort("mo"), toRTT(policy)  );
+    cce = ports->buildChannelOutput("mi", policy);
+    ports->channelReady("mi", cce, policy);
+    BOOST_REQUIRE( cce.in() );
+    bce = CRemoteBatchChannelElement::_narrow( cce.in() );
+    BOOST_REQUIRE( !CORBA::is_nil( bce.in() ) );
+
+    samples = new CSamples();
+    samples->length(5);
+    for (CORBA::ULong i = 0; i != 5; ++i)
+        samples[i] <<= i + 0.25;
+    BOOST_CHECK( bce->writeSamples( samples.in() ) );
+    for (int i = 0; i != 5; ++i) {
+        result = 0.0;
+        wait_for_equal( mi->read( result ), NewData, 5 );
+        BOOST_CHECK_EQUAL( result, i + 0.25 );
+    }
+    BOOST_CHECK_EQUAL( mi->read( result ), OldData );
+
+    cce->disconnect();
+    mi->disconnect();
+
+    // test a full remote connection, which negotiates batched transfers
+    // in both directions: mo --> peerBB.mi --> peerBB.mo --> mi
+    ts2  = corba::TaskContextServer::Create( tc, /* use_naming = */ false );
+    s2 = ts2->server();
+    corba::CDataFlowInterface_var ports2 = s2->ports();
+    BOOST_CHECK( tc->start() );
+    for (int pull = 0; pull != 2; ++pull) {
+        policy.pull = pull;
+        BOOST_CHECK( ports2->createConnection("mo", ports, "mi", policy) );
+        BOOST_CHECK( ports->createConnection("mo", ports2, "mi", policy) );
+        for (int i = 0; i != 8; ++i)
+            mo->write( i + 0.75 );
+        for (int i = 0; i != 8; ++i) {
+            result = 0.0;
+            wait_for_equal( mi->read( result ), NewData, 5 );
+            BOOST_CHECK_EQUAL( result, i + 0.75 );
+        }
+        ports2->disconnectPort("mo");
+        ports2->disconnectPort("mi");
+        testPortDisconnected();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -25,6 +25,10 @@
 #include <boost/scoped_ptr.hpp>
 #include <Activity.hpp>
 #include <base/RunnableInterface.hpp>
+#include <os/TimeService.hpp>
+#include <os/Atomic.hpp>
+#include <vector>
+#include <algorithm>
 
 using namespace boost;
 using namespace std;
@@ -63,6 +67,67 @@ struct TestLog
   }
 };
 
+/**
+ * Logs a number of lines as fast as it can and records the
+ * total and worst case duration of a log call.
+ */
+struct BenchLog
+  : public RunnableInterface
+{
+  int lines;
+  os::TimeService::ticks total, worst;
+  os::AtomicInt done;
+  BenchLog(int lines) : lines(lines), total(0), worst(0) {}
+
+  bool initialize() { total = worst = 0; return true; }
+  void step() {}
+  void loop() {
+      for (int i = 0; i != lines; ++i) {
+          os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+          log(Info) << "Benchmark line " << i << " of " << lines << endlog();
+          os::TimeService::ticks duration = os::TimeService::Instance()->ticksSince(start);
+          total += duration;
+          if (duration > worst)
+              worst = duration;
+      }
+      done.inc();
+  }
+  void finalize() {}
+};
+
+/**
+ * Runs BenchLog in three threads at once and prints the latencies.
+ */
+static void benchLog(const std::string& name)
+{
+    const int threads = 3, lines = 1000;
+    std::vector<BenchLog*> runs;
+    std::vector<Activity*> activities;
+    unsigned int dropped = Logger::log().getDroppedCount();
+    for (int i = 0; i != threads; ++i) {
+        runs.push_back( new BenchLog(lines) );
+        activities.push_back( new Activity(ORO_SCHED_OTHER, 0, 0, runs.back(), "BenchLog") );
+    }
+    for (int i = 0; i != threads; ++i)
+        activities[i]->start();
+    for (int i = 0; i != threads; ++i) {
+        while ( runs[i]->done.read() == 0 )
+            usleep(1000);
+        activities[i]->stop();
+    }
+
+    os::TimeService::ticks total = 0, worst = 0;
+    for (int i = 0; i != threads; ++i) {
+        total += runs[i]->total;
+        worst = std::max(worst, runs[i]->worst);
+        delete activities[i];
+        delete runs[i];
+    }
+    cout << name << " logging, " << threads << " threads: average "
+         << os::TimeService::ticks2nsecs(total) / (threads * lines) << " ns, worst "
+         << os::TimeService::ticks2nsecs(worst) << " ns per line, "
+         << Logger::log().getDroppedCount() - dropped << " lines dropped." << endl;
+}
 
 BOOST_FIXTURE_TEST_SUITE( LoggerTestSuite, LoggerTest )
 
@@ -118,4 +183,52 @@ BOOST_AUTO_TEST_CASE( testThreadLog )
 
 }
 
+BOOST_AUTO_TEST_CASE( testAsyncLog )
+{
+#ifdef OROSEM_REMOTE_LOGGING
+    while ( !logger->getLogLine().empty() )
+        ;
+#endif
+    BOOST_REQUIRE( logger->startAsync(16) );
+    BOOST_CHECK( logger->isAsync() );
+    BOOST_CHECK( logger->startAsync() == false );
+    {
+        Logger::In in("AsyncTest");
+        BOOST_CHECK_EQUAL( std::string("AsyncTest"), logger->getLogModule() );
+        log(Info) << "Async line " << 1 << endlog();
+        log(Info) << "Async line " << 2.5 << endlog();
+        log(Info) << std::string(1000, 'x') << endlog();
+    }
+    logger->stopAsync();
+    BOOST_CHECK( logger->isAsync() == false );
+
+#ifdef OROSEM_REMOTE_LOGGING
+    // lines of one thread are written in order, long lines are truncated.
+    std::vector<std::string> lines;
+    for (std::string line = logger->getLogLine(); !line.empty(); line = logger->getLogLine())
+        lines.push_back(line);
+    int first = -1, second = -1, third = -1;
+    for (unsigned int i = 0; i != lines.size(); ++i) {
+        if ( lines[i].find("[AsyncTest] Async line 1") != std::string::npos )
+            first = i;
+        if ( lines[i].find("[AsyncTest] Async line 2.5") != std::string::npos )
+            second = i;
+        if ( lines[i].find("[AsyncTest] xxx") != std::string::npos )
+            third = i;
+    }
+    BOOST_CHECK( first != -1 );
+    BOOST_CHECK( second > first );
+    BOOST_REQUIRE( third > second );
+    BOOST_CHECK( lines[third].size() < 1000 );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( testAsyncLogLatency )
+{
+    benchLog("Synchronous");
+    BOOST_REQUIRE( logger->startAsync(1024) );
+    benchLog("Asynchronous");
+    logger->stopAsync();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
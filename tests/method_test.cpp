@@ -20,11 +20,19 @@
 
 #define ORO_TEST_OPERATION_CALLER
 
+// need access to the TLSF statistics embedded in RTT
+#define ORO_MEMORY_POOL
+#include <rtt/os/tlsf/tlsf.h>
+
 #include <TaskContext.hpp>
 #include <OperationCaller.hpp>
 #include <Operation.hpp>
 #include <Service.hpp>
 
+#include <os/TimeService.hpp>
+#include <vector>
+#include <algorithm>
+
 #include "unit.hpp"
 #include "operations_fixture.hpp"
 
@@ -425,4 +433,111 @@ BOOST_AUTO_TEST_CASE(testDSOperationCaller)
 
 }
 
+/**
+ * Sends from a reserved pool until a record comes free. A collected
+ * record is only released once the caller's engine has processed the
+ * reply, which may lag the collect() by a few microseconds.
+ */
+static SendHandle<double(int)> sendPooled(OperationCaller<double(int)>& m, int a, unsigned int& retries)
+{
+    SendHandle<double(int)> h = m.send(a);
+    while ( !h.ready() ) {
+        ++retries;
+        usleep(10);
+        h = m.send(a);
+    }
+    return h;
+}
+
+BOOST_AUTO_TEST_CASE(testOperationCallerSendPool)
+{
+    OperationCaller<double(int)> m1("m1", &OperationsFixture::m1, this, tc->engine(), caller->engine(), OwnThread);
+    OperationCaller<double(int)> none;
+
+    BOOST_REQUIRE( tc->isRunning() );
+    BOOST_REQUIRE( caller->isRunning() );
+    BOOST_CHECK( !none.reserveSends(2) );
+    BOOST_CHECK( m1.reserveSends(2) );
+
+    // both records remain in use as long as the handles exist.
+    SendHandle<double(int)> h1 = m1.send(1);
+    SendHandle<double(int)> h2 = m1.send(2);
+    SendHandle<double(int)> h3 = m1.send(3);
+    BOOST_CHECK_EQUAL( SendFailure, h3.collect() );
+    BOOST_CHECK_THROW( m1(3), SendStatus );
+
+    double retn = 0;
+    BOOST_CHECK_EQUAL( SendSuccess, h1.collect(retn) );
+    BOOST_CHECK_EQUAL( retn, -2.0 );
+    BOOST_CHECK_EQUAL( SendSuccess, h2.collect(retn) );
+    BOOST_CHECK_EQUAL( retn, 2.0 );
+
+    // releasing the handles makes the records available again.
+    h1 = SendHandle<double(int)>();
+    h2 = SendHandle<double(int)>();
+    unsigned int retries = 0;
+    for (int i = 0; i != 10; ++i) {
+        h1 = sendPooled(m1, 1, retries);
+        BOOST_CHECK_EQUAL( SendSuccess, h1.collect(retn) );
+        BOOST_CHECK_EQUAL( retn, -2.0 );
+        h1 = SendHandle<double(int)>();
+    }
+    BOOST_CHECK_EQUAL( 2.0, m1(4) );
+
+    // resetting the pool restores allocating sends.
+    BOOST_CHECK( m1.reserveSends(0) );
+    h1 = m1.send(1);
+    h2 = m1.send(2);
+    h3 = m1.send(3);
+    BOOST_CHECK_EQUAL( SendSuccess, h3.collect(retn) );
+    BOOST_CHECK_EQUAL( retn, 2.0 );
+}
+
+/**
+ * Measures the send()/collect() round trip with and without a reserved
+ * pool, and the real-time heap taken by sends which are still pending.
+ */
+BOOST_AUTO_TEST_CASE(testOperationCallerSendPoolLatency)
+{
+    const unsigned int rounds = 1000;
+    const unsigned int pending = 16;
+    for (unsigned int pool = 0; pool <= pending; pool += pending) {
+        OperationCaller<double(int)> m1("m1", &OperationsFixture::m1, this, tc->engine(), caller->engine(), OwnThread);
+        BOOST_REQUIRE( m1.reserveSends(pool) );
+
+        double retn = 0;
+        unsigned int retries = 0;
+        os::TimeService::Seconds worst = 0;
+        os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+        for (unsigned int i = 0; i != rounds; ++i) {
+            os::TimeService::ticks t = os::TimeService::Instance()->getTicks();
+            SendHandle<double(int)> h = sendPooled(m1, i, retries);
+            BOOST_CHECK_EQUAL( SendSuccess, h.collect(retn) );
+            worst = std::max(worst, os::TimeService::Instance()->secondsSince(t));
+        }
+        os::TimeService::Seconds elapsed = os::TimeService::Instance()->secondsSince(start);
+
+        // keep a number of sends pending to see what they take from the heap.
+        std::vector<SendHandle<double(int)> > handles(pending);
+#ifdef OS_RT_MALLOC
+        size_t used = get_used_size_mp();
+#endif
+        for (unsigned int i = 0; i != pending; ++i)
+            handles[i] = sendPooled(m1, i, retries);
+#ifdef OS_RT_MALLOC
+        long grown = long(get_used_size_mp()) - long(used);
+#endif
+        for (unsigned int i = 0; i != pending; ++i)
+            BOOST_CHECK_EQUAL( SendSuccess, handles[i].collect(retn) );
+
+        cout << "send/collect pool=" << pool << ": average " << elapsed / rounds * 1e6 << "us, worst " << worst * 1e6 << "us";
+        if (pool)
+            cout << ", " << retries << " retries on busy records";
+#ifdef OS_RT_MALLOC
+        cout << ", " << pending << " pending sends took " << grown << " bytes of RT heap";
+#endif
+        cout << "." << endl;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
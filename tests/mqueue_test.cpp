@@ -25,6 +25,7 @@
 #include <transports/mqueue/MQChannelElement.hpp>
 #include <transports/mqueue/MQTemplateProtocol.hpp>
 #include <os/fosi.h>
+#include <os/TimeService.hpp>
 
 using namespace std;
 using namespace RTT;
@@ -286,6 +287,71 @@ BOOST_AUTO_TEST_CASE( testPortStreams )
     testPortDisconnected();
 }
 
+BOOST_AUTO_TEST_CASE( testPortStreamsBatched )
+{
+    // Samples are only sent when a batch is full or when the
+    // writer's updateHook() returns.
+    policy.type = ConnPolicy::BUFFER;
+    policy.pull = false;
+    policy.size = 10;
+    policy.batch = 4;
+    policy.name_id = "/batch1";
+    BOOST_REQUIRE( mw1->createStream( policy ) );
+    BOOST_REQUIRE( mr2->createStream( policy ) );
+    BOOST_CHECK( mw1->connected() );
+    BOOST_CHECK( mr2->connected() );
+
+    double value = 0;
+    mw1->write(1.0);
+    mw1->write(2.0);
+    mw1->write(3.0);
+    usleep(100000);
+    BOOST_CHECK( NoData == mr2->read(value) );
+
+    ASSERT_PORT_SIGNALLING(mw1->write(4.0), mr2);
+    for (double i = 1.0; i <= 4.0; ++i) {
+        BOOST_CHECK( NewData == mr2->read(value) );
+        BOOST_CHECK_EQUAL( i, value );
+    }
+    BOOST_CHECK( OldData == mr2->read(value) );
+
+    mw1->write(5.0);
+    usleep(100000);
+    BOOST_CHECK( OldData == mr2->read(value) );
+    ASSERT_PORT_SIGNALLING(tc->trigger(), mr2);
+    BOOST_CHECK( NewData == mr2->read(value) );
+    BOOST_CHECK_EQUAL( 5.0, value );
+
+    mw1->disconnect();
+    mr2->disconnect();
+    testPortDisconnected();
+}
+
+BOOST_AUTO_TEST_CASE( testPortStreamsBatchedThroughput )
+{
+    // Compares the cost of writing samples with and without batching.
+    policy.type = ConnPolicy::BUFFER;
+    policy.pull = false;
+    policy.size = 10;
+    const int samples = 10000;
+    for (int batch = 0; batch <= 32; batch += 32) {
+        policy.batch = batch;
+        policy.name_id = "/batch2";
+        BOOST_REQUIRE( mw1->createStream( policy ) );
+        BOOST_REQUIRE( mr2->createStream( policy ) );
+
+        os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+        for (int i = 0; i != samples; ++i)
+            mw1->write( double(i) );
+        os::TimeService::Seconds elapsed = os::TimeService::Instance()->secondsSince(start);
+        cout << "mqueue batch=" << batch << ": " << samples << " writes in " << elapsed << "s." << endl;
+
+        mw1->disconnect();
+        mr2->disconnect();
+        testPortDisconnected();
+    }
+}
+
 BOOST_AUTO_TEST_CASE( testPortStreamsTimeout )
 {
     // Test creating an input stream without an output stream available.
@@ -27,11 +27,16 @@
 #include <extras/SimulationThread.hpp>
 
 #include <boost/function_types/function_type.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <OperationCaller.hpp>
 
 #include <rtt-config.h>
+#include <Activity.hpp>
+#include <os/TimeService.hpp>
 
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 using namespace RTT;
@@ -55,6 +60,28 @@ public:
     }
 };
 
+/**
+ * Connects and disconnects a reader to \a port as fast as possible.
+ */
+struct ConnectionChurner : public RunnableInterface
+{
+    volatile bool stop;
+    OutputPort<double>& port;
+    InputPort<double> reader;
+    int cycles;
+    ConnectionChurner(OutputPort<double>& p) : stop(false), port(p), reader("churn"), cycles(0) {}
+    bool initialize() { stop = false; cycles = 0; return true; }
+    void step() {
+        while (stop == false) {
+            port.connectTo(&reader, ConnPolicy::data());
+            reader.disconnect();
+            ++cycles;
+        }
+    }
+    void finalize() {}
+    bool breakLoop() { stop = true; return true; }
+};
+
 /**
  * Fixture.
  */
@@ -760,5 +787,131 @@ BOOST_AUTO_TEST_CASE(testPortDataSource)
     BOOST_CHECK_EQUAL(20, source->value());
 }
 
+BOOST_AUTO_TEST_CASE(testPortWriteLatencyDuringConnect)
+{
+    OutputPort<double> wp("Writer");
+    InputPort<double> rp1("Reader1"), rp2("Reader2");
+    BOOST_REQUIRE( wp.connectTo(&rp1, ConnPolicy::data()) );
+    BOOST_REQUIRE( wp.connectTo(&rp2, ConnPolicy::buffer(10)) );
+
+    ConnectionChurner churner(wp);
+    boost::scoped_ptr<Activity> cthread( new Activity(ORO_SCHED_OTHER, 0, 0, &churner, "ConnectionChurner" ));
+
+    const unsigned int writes = 200000;
+    std::vector<TimeService::nsecs> latencies;
+    latencies.reserve(writes);
+    double sample;
+    BOOST_REQUIRE( cthread->start() );
+    for (unsigned int i = 0; i != writes; ++i) {
+        TimeService::ticks start = TimeService::Instance()->getTicks();
+        wp.write( double(i) );
+        latencies.push_back( TimeService::ticks2nsecs( TimeService::Instance()->ticksSince(start) ) );
+        rp2.read(sample);
+    }
+    cthread->stop();
+
+    // the permanent connections must not have been affected by the churn.
+    BOOST_CHECK_EQUAL( rp1.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, double(writes - 1) );
+    BOOST_CHECK( wp.connected() );
+
+    std::sort( latencies.begin(), latencies.end() );
+    cout << "OutputPort::write() latency during " << churner.cycles << " connect/disconnect cycles (ns):"
+         << " median " << latencies[writes / 2]
+         << " p99 " << latencies[writes * 99 / 100]
+         << " p99.9 " << latencies[writes * 999 / 1000]
+         << " max " << latencies.back() << endl;
+}
+
+BOOST_AUTO_TEST_CASE(testPortSharedConnections)
+{
+    OutputPort<double> wp("Writer");
+    InputPort<double> rp1("Reader1"), rp2("Reader2"), rp3("Reader3");
+    ConnPolicy policy = ConnPolicy::buffer(4);
+    policy.shared = true;
+    BOOST_REQUIRE( wp.connectTo(&rp1, policy) );
+    BOOST_REQUIRE( wp.connectTo(&rp2, policy) );
+
+    double sample = 0;
+    BOOST_CHECK_EQUAL( rp1.read(sample), NoData );
+    wp.write(1.0);
+    wp.write(2.0);
+    // every reader sees every sample, at its own pace.
+    BOOST_CHECK_EQUAL( rp1.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 1.0 );
+    BOOST_CHECK_EQUAL( rp1.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 2.0 );
+    BOOST_CHECK_EQUAL( rp1.read(sample), OldData );
+    BOOST_CHECK_EQUAL( rp2.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 1.0 );
+
+    // a lagging reader loses its oldest samples, the writer never blocks.
+    for (int i = 3; i != 9; ++i)
+        wp.write( double(i) );
+    BOOST_CHECK_EQUAL( rp2.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 5.0 );
+
+    // removing the reader that stores the samples must not affect the others.
+    rp1.disconnect();
+    BOOST_REQUIRE( wp.connectTo(&rp3, policy) );
+    wp.write(9.0);
+    BOOST_CHECK_EQUAL( rp3.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 9.0 );
+    for (int i = 6; i != 10; ++i) {
+        BOOST_CHECK_EQUAL( rp2.read(sample), NewData );
+        BOOST_CHECK_EQUAL( sample, double(i) );
+    }
+    BOOST_CHECK_EQUAL( rp2.read(sample), OldData );
+
+    // shared data connections.
+    OutputPort<double> dwp("DataWriter");
+    InputPort<double> drp1("DataReader1"), drp2("DataReader2");
+    policy = ConnPolicy::data();
+    policy.shared = true;
+    BOOST_REQUIRE( dwp.connectTo(&drp1, policy) );
+    BOOST_REQUIRE( dwp.connectTo(&drp2, policy) );
+    dwp.write(1.0);
+    BOOST_CHECK_EQUAL( drp1.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 1.0 );
+    BOOST_CHECK_EQUAL( drp1.read(sample), OldData );
+    BOOST_CHECK_EQUAL( drp2.read(sample), NewData );
+    drp2.clear();
+    BOOST_CHECK_EQUAL( drp2.read(sample), NoData );
+    dwp.write(2.0);
+    BOOST_CHECK_EQUAL( drp2.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample, 2.0 );
+}
+
+BOOST_AUTO_TEST_CASE(testPortSharedWriteCost)
+{
+    const unsigned int readers = 8, writes = 200;
+    std::vector<double> sample(25000, 1.0); // 200KB
+    for (int shared = 0; shared != 2; ++shared) {
+        OutputPort< std::vector<double> > wp("Writer");
+        wp.setDataSample(sample);
+        std::vector< InputPort< std::vector<double> >* > rps;
+        ConnPolicy policy = ConnPolicy::data();
+        policy.shared = shared;
+        for (unsigned int i = 0; i != readers; ++i) {
+            rps.push_back( new InputPort< std::vector<double> >("Reader") );
+            BOOST_REQUIRE( wp.connectTo(rps.back(), policy) );
+        }
+
+        TimeService::ticks start = TimeService::Instance()->getTicks();
+        for (unsigned int i = 0; i != writes; ++i)
+            wp.write(sample);
+        TimeService::nsecs elapsed = TimeService::ticks2nsecs( TimeService::Instance()->ticksSince(start) );
+
+        std::vector<double> result;
+        for (unsigned int i = 0; i != readers; ++i) {
+            BOOST_CHECK_EQUAL( rps[i]->read(result), NewData );
+            BOOST_CHECK_EQUAL( result.size(), sample.size() );
+            delete rps[i];
+        }
+        cout << "OutputPort::write() of 200KB to " << readers << (shared ? " shared" : " private")
+             << " data connections: " << elapsed / writes << " ns" << endl;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -29,6 +29,7 @@
 #include <extras/SimulationThread.hpp>
 #include <extras/SimulationActivity.hpp>
 #include <Service.hpp>
+#include <os/TimeService.hpp>
 
 #include <TaskContext.hpp>
 #include <OperationCaller.hpp>
@@ -537,6 +538,46 @@ BOOST_AUTO_TEST_CASE(testSend)
     this->finishProgram( tc, "x");
 }
 
+/**
+ * Measures a 1000 statement program which is executed once per cycle.
+ */
+BOOST_AUTO_TEST_CASE(testProgramCycle)
+{
+    const int statements = 1000, cycles = 500;
+    stringstream prog;
+    prog << "program x {\n var int j = 0\n";
+    for (int i = 0; i != statements; ++i)
+        prog << " set j = j + 1\n";
+    prog << " do test.assert( j == " << statements << " )\n}";
+
+    Parser::ParsedPrograms pg_list;
+    try {
+        pg_list = parser.parseProgram( prog.str(), tc );
+    }
+    catch( const file_parse_exception& exc )
+        {
+            BOOST_REQUIRE_MESSAGE( false, exc.what() );
+        }
+    BOOST_REQUIRE( !pg_list.empty() );
+    ProgramInterfacePtr pi = *pg_list.begin();
+    BOOST_REQUIRE( sa->loadProgram( pi ) );
+
+    os::TimeService::ticks total = 0, worst = 0;
+    for (int c = 0; c != cycles; ++c) {
+        os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+        BOOST_REQUIRE( pi->start() );
+        pi->execute();
+        os::TimeService::ticks duration = os::TimeService::Instance()->ticksSince( start );
+        BOOST_REQUIRE( pi->isStopped() );
+        total += duration;
+        worst = std::max( worst, duration );
+    }
+    cout << statements << " statement program: average "
+         << os::TimeService::ticks2nsecs( total ) / cycles / 1000 << " us, worst "
+         << os::TimeService::ticks2nsecs( worst ) / 1000 << " us per cycle." << endl;
+    this->finishProgram( tc, "x" );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 void ProgramTest::doProgram( const std::string& prog, TaskContext* tc, bool test )
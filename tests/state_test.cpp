@@ -33,6 +33,7 @@
 #include <Port.hpp>
 #include <scripting/ScriptingService.hpp>
 #include <rt_string.hpp>
+#include <os/TimeService.hpp>
 #include "operations_fixture.hpp"
 
 #include <string>
@@ -1796,6 +1797,45 @@ BOOST_AUTO_TEST_CASE( testSelfDeactivatingStateMachineinTransition )
     BOOST_CHECK( !sm->isActive() );
 }
 
+/**
+ * Measures the steps of a generated StateMachine of 300 states and
+ * 2400 transitions, which visits every state ten times.
+ */
+BOOST_AUTO_TEST_CASE( testStateMachineThroughput )
+{
+    const int states = 300, laps = 10;
+    stringstream prog;
+    prog << "StateMachine X {\n var int c = 0\n";
+    prog << " initial state INIT {\n  transitions { select S0 }\n }\n";
+    for (int i = 0; i != states; ++i) {
+        prog << " state S" << i << " {\n  entry { set c = c + 1 }\n  transitions {\n";
+        for (int k = 1; k != 6; ++k)
+            prog << "   if c < 0 then select S" << (i + 7 * k) % states << "\n";
+        prog << "   if false then select S" << (i + 3) % states << "\n";
+        prog << "   if c >= " << states * laps << " then select FINI\n";
+        prog << "   select S" << (i + 1) % states << "\n  }\n }\n";
+    }
+    prog << " final state FINI {\n }\n}\nRootMachine X x\n";
+    this->parseState( prog.str(), tc );
+
+    StateMachinePtr sm = sa->getStateMachine("x");
+    BOOST_REQUIRE( sm );
+    BOOST_REQUIRE( sm->activate() );
+    BOOST_REQUIRE( sm->automatic() );
+    int steps = 0;
+    os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+    while ( !sm->inFinalState() && !sm->inError() && steps != 4 * states * laps ) {
+        sm->execute();
+        ++steps;
+    }
+    os::TimeService::ticks duration = os::TimeService::Instance()->ticksSince( start );
+    BOOST_CHECK( sm->inState("FINI") );
+    cout << states << " states, " << 8 * states + 1 << " transitions: "
+         << steps << " steps in " << os::TimeService::ticks2nsecs( duration ) / 1000000 << " ms, "
+         << os::TimeService::ticks2nsecs( duration ) / steps << " ns per step." << endl;
+    this->finishState( "x", tc );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 void StateTest::doState(  const std::string& name, const std::string& prog, TaskContext* tc, bool test, int runs )
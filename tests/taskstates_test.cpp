@@ -29,6 +29,8 @@
 
 #include <boost/function_types/function_type.hpp>
 #include <OperationCaller.hpp>
+#include <InputPort.hpp>
+#include <ExecutionStatistics.hpp>
 
 using namespace std;
 using namespace RTT;
@@ -866,5 +868,97 @@ BOOST_AUTO_TEST_CASE(test_calling_stop_concurrently_with_updateHook_calling_stop
     BOOST_REQUIRE_EQUAL(TaskCore::Stopped, task.getTargetState());
 }
 
+class ProfiledTC : public RTT::TaskContext
+{
+public:
+    ProfiledTC() : RTT::TaskContext("profiled")
+    {
+        this->addOperation("nop", &ProfiledTC::nop, this, RTT::OwnThread);
+    }
+
+    void nop() {}
+
+    void updateHook()
+    {
+        usleep(2000);
+    }
+};
+
+/**
+ * Tests the statistics of the profiling service.
+ */
+BOOST_AUTO_TEST_CASE( testProfiling )
+{
+    ProfiledTC ptc;
+    BOOST_REQUIRE( ptc.setActivity( new SlaveActivity(0.001) ) );
+    BOOST_REQUIRE( ptc.provides()->hasService("profiling") );
+    Service::shared_ptr profiling = ptc.provides("profiling");
+
+    OperationCaller<void(bool)> enable = profiling->getOperation("enable");
+    OperationCaller<void()> reset = profiling->getOperation("reset");
+    OperationCaller<ExecutionStatistics()> getStatistics = profiling->getOperation("getStatistics");
+    OperationCaller<bool(double)> setPublishPeriod = profiling->getOperation("setPublishPeriod");
+    BOOST_REQUIRE( enable.ready() && reset.ready() && getStatistics.ready() && setPublishPeriod.ready() );
+
+    InputPort<ExecutionStatistics> statistics;
+    BOOST_REQUIRE( profiling->getPort("statistics") );
+    BOOST_REQUIRE( profiling->getPort("statistics")->connectTo(&statistics) );
+
+    BOOST_REQUIRE( ptc.start() );
+    BOOST_CHECK( !ptc.engine()->isProfiling() );
+    BOOST_CHECK( ptc.getActivity()->execute() );
+    BOOST_CHECK_EQUAL( getStatistics().cycles, 0u );
+
+    enable(true);
+    BOOST_CHECK( setPublishPeriod(0.0) );
+    BOOST_CHECK( !setPublishPeriod(-1.0) );
+    BOOST_CHECK( ptc.engine()->isProfiling() );
+
+    // queue some messages for the next cycle.
+    OperationCaller<void()> nop = ptc.getOperation("nop");
+    for (int i = 0; i != 3; ++i)
+        nop.send();
+
+    for (int i = 0; i != 5; ++i) {
+        usleep(10000);
+        BOOST_CHECK( ptc.getActivity()->execute() );
+    }
+
+    ExecutionStatistics stats = getStatistics();
+    BOOST_CHECK_EQUAL( stats.cycles, 5u );
+    BOOST_CHECK_EQUAL( stats.updates, 5u );
+    BOOST_CHECK_EQUAL( stats.period, 0.001 );
+    BOOST_CHECK( stats.hook_mean >= 0.002 );
+    BOOST_CHECK( stats.hook_max >= stats.hook_mean );
+    BOOST_CHECK( stats.messages_max >= stats.messages_mean );
+    BOOST_CHECK_EQUAL( stats.messages_depth_max, 3u );
+    // 2ms takes at least bin 11, which counts the durations below 2048us.
+    unsigned int histogram = 0;
+    for (int i = 11; i != ExecutionStatistics::HistogramBins; ++i)
+        histogram += stats.hook_histogram[i];
+    BOOST_CHECK_EQUAL( histogram, 5u );
+    // each cycle takes longer than the period and starts 10ms too late.
+    BOOST_CHECK_EQUAL( stats.overruns, 5u );
+    BOOST_CHECK( stats.jitter_mean >= 0.009 );
+    BOOST_CHECK( stats.jitter_max >= stats.jitter_mean );
+
+    // the port has the statistics of the previous cycle.
+    ExecutionStatistics sample;
+    BOOST_CHECK_EQUAL( statistics.read(sample), NewData );
+    BOOST_CHECK_EQUAL( sample.cycles, 4u );
+
+    reset();
+    BOOST_CHECK( ptc.getActivity()->execute() );
+    BOOST_CHECK_EQUAL( getStatistics().cycles, 1u );
+    BOOST_CHECK_EQUAL( getStatistics().messages_depth_max, 0u );
+
+    // disabling keeps the statistics.
+    enable(false);
+    BOOST_CHECK( !ptc.engine()->isProfiling() );
+    BOOST_CHECK( ptc.getActivity()->execute() );
+    BOOST_CHECK_EQUAL( getStatistics().cycles, 1u );
+    BOOST_CHECK( ptc.stop() );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
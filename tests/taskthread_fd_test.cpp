@@ -23,6 +23,7 @@
 
 #include <TaskContext.hpp>
 #include <extras/FileDescriptorActivity.hpp>
+#include <extras/FileDescriptorPoller.hpp>
 #include <os/MainThread.hpp>
 #include <Logger.hpp>
 #include <rtt-config.h>
@@ -291,5 +292,59 @@ BOOST_AUTO_TEST_CASE(testFileDescriptor_Timeout )
     BOOST_CHECK_LE( 0, mcomp.countUpdate );
 }
 
+BOOST_AUTO_TEST_CASE(testFileDescriptorPoller )
+{
+    extras::FileDescriptorPoller poller;
+    BOOST_REQUIRE( poller.isOpen() );
+
+    static const int PIPES = 64;
+    int fds[PIPES][2];
+    for (int i = 0; i != PIPES; ++i) {
+        BOOST_REQUIRE( pipe(fds[i]) == 0 );
+        BOOST_CHECK( poller.add(fds[i][0]) );
+    }
+    BOOST_CHECK_EQUAL( std::size_t(PIPES), poller.size() );
+    BOOST_CHECK( poller.add(-1) == false );
+
+    // timeout, also below the millisecond
+    BOOST_CHECK_EQUAL( 0, poller.wait(1500) );
+    BOOST_CHECK( poller.ready().empty() );
+
+    char ch = 'a';
+    BOOST_CHECK_EQUAL( 1, write(fds[10][1], &ch, 1) );
+    BOOST_CHECK_EQUAL( 1, write(fds[50][1], &ch, 1) );
+    BOOST_CHECK_EQUAL( 2, poller.wait(100000) );
+    BOOST_CHECK( poller.isReady(fds[10][0]) );
+    BOOST_CHECK( poller.isReady(fds[50][0]) );
+    BOOST_CHECK( !poller.isReady(fds[11][0]) );
+    BOOST_CHECK( !poller.isWoken() );
+
+    // unread data is reported again, removed descriptors are not
+    BOOST_CHECK( poller.remove(fds[10][0]) );
+    BOOST_CHECK( poller.remove(fds[10][0]) == false );
+    BOOST_CHECK( !poller.isWatched(fds[10][0]) );
+    BOOST_CHECK_EQUAL( 1, poller.wait(100000) );
+    BOOST_CHECK( poller.isReady(fds[50][0]) );
+    BOOST_CHECK_EQUAL( 1, read(fds[50][0], &ch, 1) );
+
+    poller.wakeup();
+    poller.wakeup();
+    BOOST_CHECK_EQUAL( 1, poller.wait(100000) );
+    BOOST_CHECK( poller.isWoken() );
+    BOOST_CHECK( poller.ready().empty() );
+    BOOST_CHECK_EQUAL( 0, poller.wait(1000) );
+
+    poller.wakeup();
+    poller.clearWakeup();
+    BOOST_CHECK_EQUAL( 0, poller.wait(1000) );
+
+    poller.clear();
+    BOOST_CHECK_EQUAL( std::size_t(0), poller.size() );
+    for (int i = 0; i != PIPES; ++i) {
+        close(fds[i][0]);
+        close(fds[i][1]);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,292 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "unit.hpp"
+
+#include <rtt-fwd.hpp>
+
+#include <rtt/TaskContext.hpp>
+#include <rtt/Activity.hpp>
+#include <rtt/InputPort.hpp>
+#include <rtt/OutputPort.hpp>
+#include <rtt/Operation.hpp>
+#include <rtt/OperationCaller.hpp>
+#include <rtt/extras/ThreadPoolActivity.hpp>
+
+#include <rtt/os/Atomic.hpp>
+#include <rtt/os/TimeService.hpp>
+#include <rtt/os/fosi.h>
+
+#include <ctime>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+using namespace RTT::extras;
+
+class PooledComponent : public TaskContext
+{
+public:
+    PooledComponent(const std::string& name)
+        : TaskContext(name), overlap(false), lat_sum(0.0), lat_max(0.0), stamp(0), busy_us(0)
+    {
+        this->addEventPort("in", in);
+        this->addPort("out", out);
+        this->addOperation("echo", &PooledComponent::echo, this, OwnThread);
+    }
+
+    int echo(int i) { return i; }
+
+    void updateHook()
+    {
+        inside.inc();
+        if ( inside.read() > 1 )
+            overlap = true;
+        if ( stamp ) {
+            double lat = os::TimeService::Instance()->secondsSince(stamp);
+            lat_sum += lat;
+            if ( lat > lat_max )
+                lat_max = lat;
+            stamp = 0;
+        }
+        int sample;
+        while ( in.read(sample) == NewData )
+            out.write(sample + 1);
+        if ( busy_us )
+            usleep(busy_us);
+        inside.dec();
+        updates.inc();
+    }
+
+    InputPort<int> in;
+    OutputPort<int> out;
+    os::AtomicInt inside;
+    os::AtomicInt updates;
+    bool overlap;
+    double lat_sum;
+    double lat_max;
+    os::TimeService::ticks volatile stamp;
+    int busy_us;
+};
+
+class CallerComponent : public TaskContext
+{
+public:
+    CallerComponent()
+        : TaskContext("caller"), result(0)
+    {
+    }
+
+    void updateHook()
+    {
+        if ( echo.ready() )
+            result = echo(42);
+    }
+
+    OperationCaller<int(int)> echo;
+    int result;
+};
+
+static bool waitForUpdates(std::vector<PooledComponent*>& comps, int count, double timeout_s = 30.0)
+{
+    os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+    for (unsigned int i = 0; i != comps.size(); ++i)
+        while ( comps[i]->updates.read() < count ) {
+            if ( os::TimeService::Instance()->secondsSince(start) > timeout_s )
+                return false;
+            usleep(1000);
+        }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE( ThreadPoolActivityTestSuite )
+
+BOOST_AUTO_TEST_CASE( testTriggeredComponents )
+{
+    ActivityPool pool(3);
+    BOOST_CHECK_EQUAL( pool.getWorkerCount(), 3u );
+
+    std::vector<PooledComponent*> comps;
+    for (int i = 0; i != 20; ++i) {
+        comps.push_back( new PooledComponent("comp") );
+        comps.back()->busy_us = 100;
+        BOOST_REQUIRE( comps.back()->setActivity( new ThreadPoolActivity(pool) ) );
+        BOOST_CHECK( !comps.back()->getActivity()->isPeriodic() );
+        BOOST_CHECK( !comps.back()->getActivity()->execute() );
+        BOOST_REQUIRE( comps.back()->start() );
+    }
+
+    // Flood each component with triggers: queued triggers are merged,
+    // but never lead to two concurrent updates of one component.
+    for (int round = 0; round != 50; ++round)
+        for (unsigned int i = 0; i != comps.size(); ++i)
+            BOOST_CHECK( comps[i]->trigger() );
+    BOOST_CHECK( waitForUpdates(comps, 1) );
+    for (int round = 0; round != 50; ++round)
+        for (unsigned int i = 0; i != comps.size(); ++i)
+            comps[i]->trigger();
+    usleep(200000);
+    for (unsigned int i = 0; i != comps.size(); ++i) {
+        BOOST_CHECK( !comps[i]->overlap );
+        BOOST_CHECK( comps[i]->updates.read() >= 2 );
+        BOOST_CHECK( comps[i]->stop() );
+    }
+
+    // a stopped component is not updated anymore
+    int updates = comps[0]->updates.read();
+    BOOST_CHECK( comps[0]->trigger() );
+    usleep(50000);
+    BOOST_CHECK_EQUAL( comps[0]->updates.read(), updates );
+
+    // a stopped activity refuses triggers
+    BOOST_CHECK( comps[0]->getActivity()->stop() );
+    BOOST_CHECK( !comps[0]->getActivity()->trigger() );
+    BOOST_CHECK( !comps[0]->trigger() );
+
+    for (unsigned int i = 0; i != comps.size(); ++i)
+        delete comps[i];
+}
+
+BOOST_AUTO_TEST_CASE( testPeriodicComponents )
+{
+    ActivityPool pool(2);
+    std::vector<PooledComponent*> comps;
+    for (int i = 0; i != 10; ++i) {
+        comps.push_back( new PooledComponent("comp") );
+        BOOST_REQUIRE( comps.back()->setActivity( new ThreadPoolActivity(pool, 0.01) ) );
+        BOOST_CHECK( comps.back()->getActivity()->isPeriodic() );
+        BOOST_CHECK_EQUAL( comps.back()->getPeriod(), 0.01 );
+        // timeout() is refused for periodic activities
+        BOOST_CHECK( !comps.back()->getActivity()->timeout() );
+        BOOST_REQUIRE( comps.back()->start() );
+    }
+    usleep(300000);
+    for (unsigned int i = 0; i != comps.size(); ++i) {
+        BOOST_CHECK( comps[i]->updates.read() >= 10 );
+        BOOST_CHECK( !comps[i]->overlap );
+    }
+
+    // switch to non periodic while running
+    BOOST_CHECK( comps[0]->getActivity()->setPeriod(0.0) );
+    BOOST_CHECK( !comps[0]->getActivity()->isPeriodic() );
+    usleep(50000);
+    int updates = comps[0]->updates.read();
+    usleep(100000);
+    BOOST_CHECK_EQUAL( comps[0]->updates.read(), updates );
+    BOOST_CHECK( !comps[0]->getActivity()->setPeriod(-1.0) );
+
+    for (unsigned int i = 0; i != comps.size(); ++i)
+        delete comps[i];
+}
+
+BOOST_AUTO_TEST_CASE( testEventPortsAndOperations )
+{
+    ActivityPool pool(2);
+    PooledComponent first("first"), second("second");
+    CallerComponent caller;
+    BOOST_REQUIRE( first.setActivity( new ThreadPoolActivity(pool) ) );
+    BOOST_REQUIRE( second.setActivity( new ThreadPoolActivity(pool) ) );
+    BOOST_REQUIRE( caller.setActivity( new ThreadPoolActivity(pool) ) );
+    BOOST_REQUIRE( first.out.connectTo(&second.in) );
+
+    OutputPort<int> source;
+    BOOST_REQUIRE( source.connectTo(&first.in) );
+    BOOST_REQUIRE( first.start() );
+    BOOST_REQUIRE( second.start() );
+
+    // an event port triggers updateHook() in a worker
+    source.write(1);
+    std::vector<PooledComponent*> comps;
+    comps.push_back(&second);
+    BOOST_CHECK( waitForUpdates(comps, 1, 5.0) );
+    int sample = 0;
+    BOOST_CHECK_EQUAL( second.in.read(sample), OldData );
+    BOOST_CHECK_EQUAL( sample, 2 );
+
+    // a pooled component calls an OwnThread operation of another one
+    caller.echo = first.getOperation("echo");
+    caller.echo.setCaller( caller.engine() );
+    BOOST_REQUIRE( caller.echo.ready() );
+    BOOST_REQUIRE( caller.start() );
+    BOOST_CHECK( caller.trigger() );
+    for (int wait = 0; wait != 500 && caller.result != 42; ++wait)
+        usleep(10000);
+    BOOST_CHECK_EQUAL( caller.result, 42 );
+    BOOST_CHECK( caller.engine()->getActivity()->thread() );
+}
+
+/**
+ * Compares the trigger to updateHook() latency and the total process
+ * CPU time of a pool of workers with one thread per component.
+ */
+BOOST_AUTO_TEST_CASE( testScaling )
+{
+    const int counts[] = { 100, 1000, 5000 };
+    const int rounds = 5;
+    ActivityPool pool(4);
+
+    for (unsigned int c = 0; c != sizeof(counts)/sizeof(counts[0]); ++c) {
+        std::vector<PooledComponent*> comps;
+        for (int i = 0; i != counts[c]; ++i)
+            comps.push_back( new PooledComponent("comp") );
+
+        for (int mode = 0; mode != 2; ++mode) {
+            bool pooled = (mode == 0);
+            int started = 0;
+            for (unsigned int i = 0; i != comps.size(); ++i) {
+                comps[i]->setActivity( pooled ? (base::ActivityInterface*) new ThreadPoolActivity(pool)
+                                              : (base::ActivityInterface*) new Activity() );
+                comps[i]->updates.set(0);
+                comps[i]->lat_sum = comps[i]->lat_max = 0.0;
+                if ( comps[i]->start() )
+                    ++started;
+            }
+            if ( started != counts[c] ) {
+                cout << counts[c] << " components, " << (pooled ? "pool" : "threads")
+                     << ": only " << started << " could be started, skipped." << endl;
+                for (unsigned int i = 0; i != comps.size(); ++i)
+                    comps[i]->stop();
+                continue;
+            }
+
+            std::clock_t cpu = std::clock();
+            os::TimeService::ticks wall = os::TimeService::Instance()->getTicks();
+            bool done = true;
+            for (int r = 1; r <= rounds && done; ++r) {
+                for (unsigned int i = 0; i != comps.size(); ++i) {
+                    comps[i]->stamp = os::TimeService::Instance()->getTicks();
+                    comps[i]->trigger();
+                }
+                done = waitForUpdates(comps, r);
+            }
+            double wall_s = os::TimeService::Instance()->secondsSince(wall);
+            double cpu_s = double(std::clock() - cpu) / CLOCKS_PER_SEC;
+            BOOST_CHECK( done );
+
+            double lat_sum = 0.0, lat_max = 0.0;
+            for (unsigned int i = 0; i != comps.size(); ++i) {
+                BOOST_CHECK( !comps[i]->overlap );
+                lat_sum += comps[i]->lat_sum;
+                if ( comps[i]->lat_max > lat_max )
+                    lat_max = comps[i]->lat_max;
+                comps[i]->stop();
+            }
+            cout << counts[c] << " components, " << (pooled ? "pool of 4" : "threads")
+                 << ": average latency " << lat_sum / (rounds * counts[c]) * 1e6
+                 << "us, worst " << lat_max * 1e6 << "us, CPU " << cpu_s
+                 << "s, wall " << wall_s << "s" << endl;
+        }
+        for (unsigned int i = 0; i != comps.size(); ++i)
+            delete comps[i];
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
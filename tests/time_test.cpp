@@ -23,6 +23,7 @@
 #include <os/Timer.hpp>
 #include <rtt-detail-fwd.hpp>
 #include <iostream>
+#include <algorithm>
 
 #define EPSILON 0.000000002
 
@@ -86,6 +87,34 @@ struct TestTimer
     }
 };
 
+/**
+ * Records how late each timer fired compared to the time it was due.
+ */
+struct LatenessTimer
+    : public Timer
+{
+    std::vector<nsecs> due;
+    std::vector<TimerId> fired;
+    nsecs total_late, worst_late;
+    LatenessTimer(TimerId max_timers)
+        :Timer(max_timers, ORO_SCHED_OTHER, os::LowestPriority),
+         due(max_timers, 0), total_late(0), worst_late(0)
+    {
+        fired.reserve(max_timers);
+    }
+    void timeout(Timer::TimerId id)
+    {
+        nsecs late = TimeService::Instance()->getNSecs() - due[id];
+        total_late += late;
+        worst_late = std::max(worst_late, late);
+        fired.push_back(id);
+    }
+    ~LatenessTimer()
+    {
+        getActivity()->stop();
+    }
+};
+
 BOOST_FIXTURE_TEST_SUITE( TimeTestSuite, TimeTest )
 
 BOOST_AUTO_TEST_CASE( testSecondsConversion )
@@ -350,4 +379,44 @@ BOOST_AUTO_TEST_CASE( testTimerWaitFor )
     BOOST_REQUIRE_CLOSE( hbg->secondsSince(0), now + 0.5, 0.1 );
 }
 
+/**
+ * Arms 10000 timers in random order, kills half of them and
+ * measures arming, killing and how late the others expire.
+ */
+BOOST_AUTO_TEST_CASE( testManyTimers )
+{
+    const Timer::TimerId count = 10000;
+    LatenessTimer timer(count);
+
+    // spread the expiry times over 0.2s, starting 0.3s from now,
+    // and arm them out of order.
+    Seconds arming = 0;
+    for (Timer::TimerId i = 0; i != count; ++i) {
+        Timer::TimerId id = (i * 7919) % count;
+        Seconds wait = 0.3 + 0.2 * id / count;
+        TimeService::ticks start = hbg->getTicks();
+        timer.due[id] = hbg->getNSecs() + Seconds_to_nsecs(wait);
+        BOOST_CHECK( timer.arm(id, wait) );
+        arming += hbg->secondsSince(start);
+    }
+
+    TimeService::ticks start = hbg->getTicks();
+    for (Timer::TimerId i = 1; i < count; i += 2)
+        BOOST_CHECK( timer.killTimer(i) );
+    Seconds killing = hbg->secondsSince(start);
+
+    sleep(1);
+
+    // only the remaining timers fired, each one once.
+    BOOST_REQUIRE_EQUAL( timer.fired.size(), size_t(count / 2) );
+    std::sort(timer.fired.begin(), timer.fired.end());
+    for (Timer::TimerId i = 0; i != count / 2; ++i)
+        BOOST_CHECK_EQUAL( timer.fired[i], 2 * i );
+
+    cout << "Timer with " << count << " timers: arm " << arming / count * 1e6 << "us, kill "
+         << killing / (count / 2) * 1e6 << "us, average lateness "
+         << nsecs_to_Seconds(timer.total_late) / (count / 2) * 1e6 << "us, worst "
+         << nsecs_to_Seconds(timer.worst_late) * 1e6 << "us." << endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
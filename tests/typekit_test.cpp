@@ -32,11 +32,65 @@
 #include <types/OperatorTypes.hpp>
 
 #include <types/SequenceTypeInfo.hpp>
+#include <types/TypeInfoName.hpp>
+#include <os/TimeService.hpp>
+#include <sstream>
 
 struct TypekitFixture
 {
 };
 
+/**
+ * A distinct C++ type for each N, to fill the type system with.
+ */
+template<int N>
+struct SyntheticType {};
+
+/**
+ * A typekit for SyntheticType<B> up to SyntheticType<B + N - 1>.
+ * The types are split in halves to keep the template depth low.
+ */
+template<int B, int N>
+struct SyntheticTypekit
+{
+    typedef SyntheticTypekit<B, N / 2> First;
+    typedef SyntheticTypekit<B + N / 2, N - N / 2> Second;
+
+    static void loadTypes() { First::loadTypes(); Second::loadTypes(); }
+    static int checkTypes() { return First::checkTypes() + Second::checkTypes(); }
+    static int cachedLookups() { return First::cachedLookups() + Second::cachedLookups(); }
+    static int lookups() { return First::lookups() + Second::lookups(); }
+};
+
+template<int B>
+struct SyntheticTypekit<B, 1>
+{
+    static std::string name() {
+        std::stringstream ss;
+        ss << "synthetic" << B;
+        return ss.str();
+    }
+
+    static void loadTypes() {
+        Types()->addType( new types::TypeInfoName<SyntheticType<B> >( name() ) );
+    }
+
+    /** Returns 1 if the type is known under its name. */
+    static int checkTypes() {
+        return Types()->getTypeInfo<SyntheticType<B> >() == Types()->type( name() );
+    }
+
+    /** Returns 1 if the type is known, as seen by a data source or port. */
+    static int cachedLookups() {
+        return internal::DataSourceTypeInfo<SyntheticType<B> >::getTypeInfo() != internal::DataSourceTypeInfo<internal::UnknownType>::getTypeInfo();
+    }
+
+    /** Returns 1 if the type is known, looking it up by its type id. */
+    static int lookups() {
+        return Types()->getTypeById( &typeid(SyntheticType<B>) ) != 0;
+    }
+};
+
 // Registers the fixture into the 'registry'
 BOOST_FIXTURE_TEST_SUITE( TypekitTestSuite, TypekitFixture )
 
@@ -69,4 +123,45 @@ BOOST_AUTO_TEST_CASE( testComposeDecompose )
     }
 }
 
+//! Loads a typekit with thousands of types next to the RealTimeTypekit,
+//! which was loaded by the test runner, and measures looking them up.
+BOOST_AUTO_TEST_CASE( testManyTypes )
+{
+    typedef SyntheticTypekit<0, 2048> Typekit;
+    const int count = 2048;
+    const int rounds = 100;
+    os::TimeService* ts = os::TimeService::Instance();
+
+    BOOST_REQUIRE( Types()->getTypeInfo<double>() );
+    BOOST_REQUIRE_EQUAL( Types()->getTypeInfo<double>(), Types()->type("double") );
+    size_t types = Types()->getTypes().size();
+    BOOST_CHECK_EQUAL( Typekit::cachedLookups(), 0 );
+    BOOST_CHECK_EQUAL( Typekit::lookups(), 0 );
+
+    os::TimeService::ticks start = ts->getTicks();
+    Typekit::loadTypes();
+    Seconds loading = ts->secondsSince(start);
+    BOOST_CHECK_EQUAL( Types()->getTypes().size(), types + count );
+    BOOST_CHECK_EQUAL( Typekit::checkTypes(), count );
+    BOOST_CHECK_EQUAL( Types()->getTypeInfo<double>(), Types()->type("double") );
+
+    int found = 0;
+    start = ts->getTicks();
+    for (int i = 0; i != rounds; ++i)
+        found += Typekit::cachedLookups();
+    Seconds cached = ts->secondsSince(start);
+    BOOST_CHECK_EQUAL( found, rounds * count );
+
+    found = 0;
+    start = ts->getTicks();
+    for (int i = 0; i != rounds; ++i)
+        found += Typekit::lookups();
+    Seconds uncached = ts->secondsSince(start);
+    BOOST_CHECK_EQUAL( found, rounds * count );
+
+    cout << "TypeInfoRepository with " << types + count << " types: loading " << count << " types took "
+         << loading * 1e3 << "ms, lookup " << uncached / (rounds * count) * 1e9 << "ns, cached lookup "
+         << cached / (rounds * count) * 1e9 << "ns." << endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -27,6 +27,9 @@
 #include <TaskContext.hpp>
 #include <scripting/ScriptingService.hpp>
 #include <scripting/Parser.hpp>
+#include <scripting/ExpressionCompiler.hpp>
+#include <scripting/ConditionInterface.hpp>
+#include <os/TimeService.hpp>
 #include <Service.hpp>
 #include <types/GlobalsRepository.hpp>
 #include <types/Types.hpp>
@@ -558,6 +561,116 @@ BOOST_AUTO_TEST_CASE( testOperatorOrder )
     executePrograms(prog);
 }
 
+/**
+ * toString() prints the last value, evaluate first.
+ */
+static std::string evaluated( DataSourceBase::shared_ptr ds )
+{
+    ds->evaluate();
+    return ds->toString();
+}
+
+/**
+ * Checks that expressions lowered by the ExpressionCompiler
+ * evaluate as the DataSource trees they were built from.
+ */
+BOOST_AUTO_TEST_CASE( testCompiledExpressions )
+{
+    Attribute<double> ad("ad", 2.5);
+    Attribute<int> ai("ai", 7);
+    unsigned int ui = 4;
+    tc->addAttribute( ad );
+    tc->addAttribute( ai );
+    tc->addAttribute( "ui", ui );
+
+    const char* lowered[] = {
+        "ad * 2.0 + 1.0",
+        "-ad / 0.5 - +ad",
+        "ai % 4 + ai / 2 - 3 * ai",
+        "ai / 0",
+        "-ai",
+        "ui * ui + ui",
+        "ad > 2.0 && ai == 7 || !(ui != 4)",
+        "ad <= 2.5 && ai >= 7 && ai < 8",
+        "ai == 7 && ad * 2.0 > 4.0 && int(ad) == 2"
+    };
+    for (unsigned int i = 0; i != sizeof(lowered) / sizeof(lowered[0]); ++i) {
+        DataSourceBase::shared_ptr tree = parser.parseExpression( lowered[i], tc );
+        BOOST_REQUIRE( tree );
+        DataSourceBase::shared_ptr compiled = ExpressionCompiler::compile( tree );
+        BOOST_CHECK_MESSAGE( compiled != tree, "Not lowered: " << lowered[i] );
+        BOOST_CHECK_EQUAL( compiled->getType(), tree->getType() );
+
+        ad.set( 2.5 ); ai.set( 7 ); ui = 4;
+        BOOST_CHECK_EQUAL( evaluated( compiled ), evaluated( tree ) );
+        ad.set( -1.25 ); ai.set( -3 ); ui = 9;
+        BOOST_CHECK_EQUAL( evaluated( compiled ), evaluated( tree ) );
+
+        // copies keep reading the same attributes.
+        std::map<const DataSourceBase*, DataSourceBase*> replace;
+        DataSourceBase::shared_ptr copy = compiled->copy( replace );
+        DataSourceBase::shared_ptr clone = compiled->clone();
+        ad.set( 8.0 ); ai.set( 11 ); ui = 1;
+        BOOST_CHECK_EQUAL( evaluated( copy ), evaluated( tree ) );
+        BOOST_CHECK_EQUAL( evaluated( clone ), evaluated( tree ) );
+    }
+
+    // these are left as they are.
+    const char* kept[] = { "ad", "\"abc\" == \"abd\"" };
+    for (unsigned int i = 0; i != sizeof(kept) / sizeof(kept[0]); ++i) {
+        DataSourceBase::shared_ptr tree = parser.parseExpression( kept[i], tc );
+        BOOST_REQUIRE( tree );
+        BOOST_CHECK_MESSAGE( ExpressionCompiler::compile( tree ) == tree, "Lowered: " << kept[i] );
+    }
+
+    ExpressionCompiler::setEnabled( false );
+    DataSourceBase::shared_ptr tree = parser.parseExpression( "ad + 1.0", tc );
+    BOOST_CHECK( ExpressionCompiler::compile( tree ) == tree );
+    ExpressionCompiler::setEnabled( true );
+
+    // conditions are lowered by the parser.
+    ad.set( 2.5 ); ai.set( 7 );
+    ConditionInterface* guard = parser.parseCondition( "ad > 2.0 && ai == 7", tc );
+    BOOST_REQUIRE( guard );
+    BOOST_CHECK( guard->evaluate() );
+    ai.set( 6 );
+    BOOST_CHECK( !guard->evaluate() );
+    delete guard;
+}
+
+/**
+ * Measures the evaluation of a guard with and without the ExpressionCompiler.
+ */
+BOOST_AUTO_TEST_CASE( testGuardThroughput )
+{
+    Attribute<double> ad("ad", 2.5);
+    Attribute<int> ai("ai", 7);
+    tc->addAttribute( ad );
+    tc->addAttribute( ai );
+    const string expr = "ad > 1.0 && ai * 2 < 100 && ad * ad + 3.0 >= ad / 2.0 || ai % 3 == 1";
+    const int evaluations = 200000;
+
+    bool results[2];
+    for (int compiled = 0; compiled != 2; ++compiled) {
+        ExpressionCompiler::setEnabled( compiled != 0 );
+        ConditionInterface* guard = parser.parseCondition( expr, tc );
+        BOOST_REQUIRE( guard );
+        bool result = false;
+        os::TimeService::ticks start = os::TimeService::Instance()->getTicks();
+        for (int i = 0; i != evaluations; ++i) {
+            ai.set( i & 0xff );
+            result = guard->evaluate() != result;
+        }
+        os::TimeService::ticks duration = os::TimeService::Instance()->ticksSince( start );
+        results[compiled] = result;
+        cout << (compiled ? "Compiled" : "DataSource tree") << " guard: "
+             << os::TimeService::ticks2nsecs( duration ) / evaluations << " ns per evaluation." << endl;
+        delete guard;
+    }
+    ExpressionCompiler::setEnabled( true );
+    BOOST_CHECK_EQUAL( results[0], results[1] );
+}
+
 BOOST_AUTO_TEST_CASE( testGlobals )
 {
     GlobalsRepository::Instance()->setValue( new Constant<double>("cd_num", 3.33));